@@ -0,0 +1,268 @@
+#include "BacktrackingAnalysis.h"
+
+#include <map>
+#include <set>
+#include <deque>
+#include <sstream>
+#include <algorithm>
+
+namespace {
+	const size_t NO_SUBSET = (size_t)(-1);
+
+	/*
+		The pseudo-DFA made deterministic: apply() follows every branch of every BranchingPoint before giving up, so after reading some input,
+		all the states of the pseudo-DFA it can have reached by then get tried -- a subset of them, accepting if any of them is final.
+		The input read is then rolled back from the furthest position any branch reaches to the furthest position any branch has accepted at.
+		Every subset keeps the subsets it leads to, each with one of the symbols leading there.
+	*/
+	struct SubsetAutomaton {
+		std::vector<bool> accepting;
+		std::vector<std::vector<std::pair<size_t, SymbolIndex>>> successors;
+
+		explicit SubsetAutomaton(const NFA& dfa) {
+			std::map<std::set<State>, size_t> subsetIndices;
+			std::deque<std::set<State>> unexplored;
+			auto subsetIndexOf = [this, &dfa, &subsetIndices, &unexplored](const std::set<State>& subset) {
+				auto subsetIt = subsetIndices.find(subset);
+				if (subsetIt != subsetIndices.cend()) {
+					return subsetIt->second;
+				}
+
+				const size_t subsetIndex = accepting.size();
+				subsetIndices.emplace(subset, subsetIndex);
+				accepting.push_back(std::any_of(subset.cbegin(), subset.cend(), [&dfa](State state) { return dfa.finalStates.count(state) > 0; }));
+				successors.emplace_back();
+				unexplored.push_back(subset);
+				return subsetIndex;
+			};
+
+			subsetIndexOf({ 0 });
+			while (!unexplored.empty()) {
+				const std::set<State> subset = unexplored.front();
+				unexplored.pop_front();
+				const size_t subsetIndex = subsetIndices.at(subset);
+
+				std::map<SymbolIndex, std::set<State>> targetsBySymbol;
+				for (State state : subset) {
+					for (const auto& transition : dfa.states[state].transitions) {
+						for (SymbolIndex symbolIndex : *transition.condition->retrieveSymbolIndices()) {
+							targetsBySymbol[symbolIndex].insert(transition.target);
+						}
+					}
+				}
+
+				std::map<size_t, SymbolIndex> symbolsBySuccessor;
+				for (const auto& targetsPair : targetsBySymbol) {
+					symbolsBySuccessor.emplace(subsetIndexOf(targetsPair.second), targetsPair.first);
+				}
+				successors[subsetIndex].assign(symbolsBySuccessor.cbegin(), symbolsBySuccessor.cend());
+			}
+		}
+
+		// the symbols along the shortest path from the source to the target, taking only the subsets the predicate allows (the target itself aside)
+		template <typename Predicate>
+		std::vector<SymbolIndex> shortestPath(size_t source, size_t target, Predicate allowed) const {
+			std::vector<std::pair<size_t, SymbolIndex>> predecessors(accepting.size(), { NO_SUBSET, 0 });
+			std::deque<size_t> queue({ source });
+			// the source is not marked as visited, so that the path may be a cycle back to it
+			while (!queue.empty() && predecessors[target].first == NO_SUBSET) {
+				const size_t subsetIndex = queue.front();
+				queue.pop_front();
+				for (const auto& successorPair : successors[subsetIndex]) {
+					if (predecessors[successorPair.first].first == NO_SUBSET && (successorPair.first == target || allowed(successorPair.first))) {
+						predecessors[successorPair.first] = successorPair;
+						predecessors[successorPair.first].first = subsetIndex;
+						queue.push_back(successorPair.first);
+					}
+				}
+			}
+
+			std::vector<SymbolIndex> ret;
+			if (source == target && predecessors[target].first == NO_SUBSET) {
+				return ret;
+			}
+			size_t subsetIndex = target;
+			do {
+				ret.push_back(predecessors[subsetIndex].second);
+				subsetIndex = predecessors[subsetIndex].first;
+			} while (subsetIndex != source);
+			std::reverse(ret.begin(), ret.end());
+			return ret;
+		}
+	};
+
+	// the symbols as a comma-separated list, possibly empty
+	std::string symbolsToString(const std::vector<SymbolIndex>& symbols) {
+		std::stringstream ss;
+		for (size_t symbolPosition = 0; symbolPosition < symbols.size(); ++symbolPosition) {
+			ss << (symbolPosition > 0 ? "," : "") << symbols[symbolPosition];
+		}
+		return ss.str();
+	}
+
+	bool symbolsFromString(const std::string& str, std::vector<SymbolIndex>& symbols) {
+		symbols.clear();
+		std::stringstream ss(str);
+		std::string symbolString;
+		while (std::getline(ss, symbolString, ',')) {
+			std::stringstream symbolStream(symbolString);
+			SymbolIndex symbolIndex;
+			if (!(symbolStream >> symbolIndex) || !symbolStream.eof()) {
+				return false;
+			}
+			symbols.push_back(symbolIndex);
+		}
+		return true;
+	}
+}
+
+std::string BacktrackingAnalysis::toString() const {
+	std::stringstream ss;
+	ss << (rollbackBounded ? 1 : 0) << ':' << maxRollback << ':' << maxBranchingFactor << ':' << branchingCells
+		<< ':' << symbolsToString(witnessToken) << ':' << symbolsToString(witnessLeadIn) << ':' << symbolsToString(witnessCycle);
+	return ss.str();
+}
+
+bool BacktrackingAnalysis::fromString(const std::string& str, BacktrackingAnalysis& analysis) {
+	std::vector<std::string> parts;
+	std::stringstream ss(str);
+	std::string part;
+	while (std::getline(ss, part, ':')) {
+		parts.push_back(part);
+	}
+	// an empty cycle, the last part, leaves nothing after the last colon for getline to find
+	if (!str.empty() && str.back() == ':') {
+		parts.emplace_back();
+	}
+	if (parts.size() != 7) {
+		return false;
+	}
+
+	std::stringstream countsStream(parts[0] + ' ' + parts[1] + ' ' + parts[2] + ' ' + parts[3]);
+	int rollbackBounded;
+	if (!(countsStream >> rollbackBounded >> analysis.maxRollback >> analysis.maxBranchingFactor >> analysis.branchingCells) || (rollbackBounded != 0 && rollbackBounded != 1)) {
+		return false;
+	}
+	analysis.rollbackBounded = rollbackBounded == 1;
+	return symbolsFromString(parts[4], analysis.witnessToken) && symbolsFromString(parts[5], analysis.witnessLeadIn) && symbolsFromString(parts[6], analysis.witnessCycle);
+}
+
+BacktrackingAnalysis BacktrackingAnalysis::analyze(const NFA& dfa) {
+	BacktrackingAnalysis ret;
+	ret.analyzeBranching(dfa);
+	ret.analyzeRollback(dfa);
+	return ret;
+}
+
+void BacktrackingAnalysis::analyzeBranching(const NFA& dfa) {
+	for (const auto& state : dfa.states) {
+		std::map<SymbolIndex, std::set<State>> targetsBySymbol;
+		for (const auto& transition : state.transitions) {
+			for (SymbolIndex symbolIndex : *transition.condition->retrieveSymbolIndices()) {
+				targetsBySymbol[symbolIndex].insert(transition.target);
+			}
+		}
+
+		for (const auto& targetsPair : targetsBySymbol) {
+			maxBranchingFactor = std::max(maxBranchingFactor, targetsPair.second.size());
+			if (targetsPair.second.size() > 1) {
+				++branchingCells;
+			}
+		}
+	}
+}
+
+void BacktrackingAnalysis::analyzeRollback(const NFA& dfa) {
+	const SubsetAutomaton subsets(dfa);
+	const size_t subsetCount = subsets.accepting.size();
+
+	// the non-accepting subsets reachable from accepting ones through non-accepting ones, i.e. those read through after a token has been accepted
+	std::vector<size_t> leadInPredecessors(subsetCount, NO_SUBSET);
+	std::vector<size_t> reachable;
+	for (size_t subsetIndex = 0; subsetIndex < subsetCount; ++subsetIndex) {
+		if (!subsets.accepting[subsetIndex]) {
+			continue;
+		}
+		for (const auto& successorPair : subsets.successors[subsetIndex]) {
+			if (!subsets.accepting[successorPair.first] && leadInPredecessors[successorPair.first] == NO_SUBSET) {
+				leadInPredecessors[successorPair.first] = subsetIndex;
+				reachable.push_back(successorPair.first);
+			}
+		}
+	}
+	for (size_t reachableIndex = 0; reachableIndex < reachable.size(); ++reachableIndex) {
+		for (const auto& successorPair : subsets.successors[reachable[reachableIndex]]) {
+			if (!subsets.accepting[successorPair.first] && leadInPredecessors[successorPair.first] == NO_SUBSET) {
+				leadInPredecessors[successorPair.first] = reachable[reachableIndex];
+				reachable.push_back(successorPair.first);
+			}
+		}
+	}
+
+	// the longest path out of every one of them, found depth-first (iteratively, the automata may have plenty of states), a subset found on the stack closing a cycle
+	enum class Visit { Unvisited, OnStack, Done };
+	std::vector<Visit> visits(subsetCount, Visit::Unvisited);
+	std::vector<size_t> longestPaths(subsetCount, 0); // in subsets entered, the subset itself included
+	for (size_t root : reachable) {
+		if (visits[root] != Visit::Unvisited) {
+			continue;
+		}
+
+		std::vector<std::pair<size_t, size_t>> stack({ { root, 0 } }); // the subsets and the indices of their successors to visit next
+		visits[root] = Visit::OnStack;
+		while (!stack.empty()) {
+			const size_t subsetIndex = stack.back().first;
+			const auto& successors = subsets.successors[subsetIndex];
+			if (stack.back().second == successors.size()) {
+				size_t longestPath = 0;
+				for (const auto& successorPair : successors) {
+					if (!subsets.accepting[successorPair.first]) {
+						longestPath = std::max(longestPath, longestPaths[successorPair.first]);
+					}
+				}
+				longestPaths[subsetIndex] = longestPath + 1;
+				visits[subsetIndex] = Visit::Done;
+				stack.pop_back();
+				continue;
+			}
+
+			const size_t successorIndex = successors[stack.back().second++].first;
+			if (subsets.accepting[successorIndex]) {
+				continue;
+			}
+			if (visits[successorIndex] == Visit::OnStack) {
+				rollbackBounded = false;
+
+				// back from the cycle to the accepting subset it is reached from, and from the initial subset to that one
+				size_t acceptingIndex = successorIndex;
+				while (!subsets.accepting[acceptingIndex]) {
+					acceptingIndex = leadInPredecessors[acceptingIndex];
+				}
+				witnessToken = subsets.shortestPath(0, acceptingIndex, [](size_t) { return true; });
+				witnessLeadIn = subsets.shortestPath(acceptingIndex, successorIndex, [&subsets](size_t subsetIndex) { return !subsets.accepting[subsetIndex]; });
+				witnessCycle = subsets.shortestPath(successorIndex, successorIndex, [&subsets](size_t subsetIndex) { return !subsets.accepting[subsetIndex]; });
+				return;
+			}
+			if (visits[successorIndex] == Visit::Unvisited) {
+				visits[successorIndex] = Visit::OnStack;
+				stack.emplace_back(successorIndex, 0);
+			}
+		}
+	}
+
+	// having accepted anything at all, apply() reads past it by at least the symbol no transition takes
+	if (std::find(subsets.accepting.cbegin(), subsets.accepting.cend(), true) == subsets.accepting.cend()) {
+		return;
+	}
+	maxRollback = 1;
+	for (size_t subsetIndex = 0; subsetIndex < subsetCount; ++subsetIndex) {
+		if (!subsets.accepting[subsetIndex]) {
+			continue;
+		}
+		for (const auto& successorPair : subsets.successors[subsetIndex]) {
+			if (!subsets.accepting[successorPair.first]) {
+				maxRollback = std::max(maxRollback, longestPaths[successorPair.first] + 1);
+			}
+		}
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include "NFA.h"
+
+/*
+	How much the generated apply() of a finite automaton may have to read again, worked out from its pseudo-DFA.
+	Cells of the transition table with more than a single target state make apply() take a BranchingPoint, and it follows every branch of it, one after another, before giving up.
+	Once out of branches, it rolls the input back from the furthest symbol any of them has read to the end of the longest token any of them has accepted:
+	the rollback distance is the longest input read on without accepting anything longer, plus the symbol no transition took.
+	Should that input be able to run through a cycle, the distance depends on the input and is unbounded -- the witness then tells an input that makes it as long as anyone likes.
+*/
+struct BacktrackingAnalysis {
+	bool rollbackBounded;
+	size_t maxRollback; // in symbols, meaningless if unbounded
+	size_t maxBranchingFactor; // the most target states of a single cell
+	size_t branchingCells; // the cells with more than a single target state
+
+	// should the rollback be unbounded, the symbols of a token accepted, followed by those read on without accepting anything into a cycle and by those of the cycle itself
+	std::vector<SymbolIndex> witnessToken;
+	std::vector<SymbolIndex> witnessLeadIn;
+	std::vector<SymbolIndex> witnessCycle;
+
+	BacktrackingAnalysis()
+		: rollbackBounded(true), maxRollback(0), maxBranchingFactor(0), branchingCells(0) { }
+
+	static BacktrackingAnalysis analyze(const NFA& dfa);
+
+	// as a single word, for the manifest to keep the analysis of machines that are not built again
+	std::string toString() const;
+	static bool fromString(const std::string& str, BacktrackingAnalysis& analysis);
+
+private:
+	void analyzeBranching(const NFA& dfa);
+	void analyzeRollback(const NFA& dfa);
+};
@@ -0,0 +1,130 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include BENCHMARK_HEADER
+#include "InterpretedAutomaton.h"
+#include "ParallelTokenizer.h"
+#include "../PeakMemory.h"
+
+// the benchmark driver astir_bench builds for every benchmarked machine (see CMakeLists.txt), the machine being given by
+//  - BENCHMARK_GRAMMAR, the name of the grammar it is defined in, as machine names repeat across the test grammars
+//  - BENCHMARK_MACHINE, the name of the machine (and of its namespace), which has to be a finite automaton on raw input
+//  - BENCHMARK_HEADER, the header generated for it
+//  - BENCHMARK_INPUT, the input generated for the machine (see `astir --corpus`), or a sample of its input to be repeated
+//  - BENCHMARK_TABLES, the .astirt tables of the machine, for the interpreted mode
+// usage: <driver> [megabytes of input, 16 by default] [input file, BENCHMARK_INPUT by default]
+
+#define BENCHMARK_STRINGIZE_EXPANDED(text) #text
+#define BENCHMARK_STRINGIZE(text) BENCHMARK_STRINGIZE_EXPANDED(text)
+
+typedef BENCHMARK_MACHINE::BENCHMARK_MACHINE BenchmarkedMachine;
+
+// every allocation the driver makes is counted, the allocations per token being the difference over a run divided by the tokens produced
+static std::atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size) {
+	++allocationCount;
+	void* ret = std::malloc(size > 0 ? size : 1);
+	if (ret == nullptr) {
+		throw std::bad_alloc();
+	}
+	return ret;
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+	std::free(pointer);
+}
+
+// an input shorter than asked for (e.g. a sample written by hand) is repeated for as long as it takes, its trailing line breaks left out as most grammars would not have them in between tokens
+std::string synthesizeInput(std::string sample, size_t length) {
+	if (sample.size() >= length) {
+		return sample;
+	}
+	while (!sample.empty() && (sample.back() == '\n' || sample.back() == '\r')) {
+		sample.pop_back();
+	}
+	std::string ret;
+	if (sample.empty()) {
+		return ret;
+	}
+	ret.reserve(length + sample.size());
+	while (ret.size() < length) {
+		ret.append(sample);
+	}
+	return ret;
+}
+
+// run() returns the number of tokens produced and sets the number of bytes of input they took
+template <typename Run>
+void measure(const std::string& mode, Run run) {
+	const size_t allocationsBefore = allocationCount;
+	auto start = std::chrono::steady_clock::now();
+	size_t byteCount = 0;
+	const size_t tokenCount = run(byteCount);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const size_t allocations = allocationCount - allocationsBefore;
+
+	std::cout << std::left << std::setw(18) << BENCHMARK_GRAMMAR << std::setw(20) << BENCHMARK_STRINGIZE(BENCHMARK_MACHINE) << std::setw(12) << mode << std::right << std::fixed << std::setprecision(2)
+		<< std::setw(12) << byteCount / (1024.0 * 1024.0) / seconds << " MB/s"
+		<< std::setw(14) << tokenCount / seconds << " tokens/s"
+		<< std::setw(10) << (tokenCount > 0 ? (double)allocations / tokenCount : 0.0) << " allocs/token"
+		<< std::setw(10) << peakResidentBytes() / (1024.0 * 1024.0) << " MB peak RSS" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	const size_t megabytes = argc > 1 ? (size_t)std::atoi(argv[1]) : 16;
+	const std::string inputFileName = argc > 2 ? argv[2] : BENCHMARK_INPUT;
+
+	std::ifstream inputFile(inputFileName, std::ios::binary);
+	if (!inputFile) {
+		std::cerr << "Could not open the input '" << inputFileName << "'" << std::endl;
+		return 1;
+	}
+	std::stringstream inputFileStream;
+	inputFileStream << inputFile.rdbuf();
+	const std::string input = synthesizeInput(inputFileStream.str(), megabytes * 1024 * 1024);
+
+	// the machine may well stop short of the end of the input if it is a sample that does not repeat well, in which case the other modes only get as far as it does
+	// the peak RSS is that of the whole process so far, the input included
+	size_t consumedByteCount = 0;
+	measure("generated", [&input, &consumedByteCount](size_t& byteCount) {
+		BenchmarkedMachine machine;
+		std::stringstream inputStream(input);
+		RawStream rs(inputStream, std::make_shared<TextLocation>());
+		const size_t tokenCount = machine.processStream(rs).size();
+		byteCount = consumedByteCount = rs.offset();
+		return tokenCount;
+	});
+	if (consumedByteCount < input.size()) {
+		std::cout << "  (stopped after " << consumedByteCount << " of the " << input.size() << " bytes of input)" << std::endl;
+	}
+	const std::string consumedInput = input.substr(0, consumedByteCount);
+
+	measure("interpreted", [&consumedInput](size_t& byteCount) {
+		InterpretedAutomaton machine(InterpretedAutomatonTable::loadFile(BENCHMARK_TABLES));
+		std::stringstream inputStream(consumedInput);
+		RawStream rs(inputStream, std::make_shared<TextLocation>());
+		const size_t tokenCount = machine.processStream(rs).size();
+		byteCount = rs.offset();
+		return tokenCount;
+	});
+
+	measure("parallel", [&consumedInput](size_t& byteCount) {
+		ParallelTokenizer<BenchmarkedMachine> parallelTokenizer;
+		byteCount = consumedInput.size();
+		return parallelTokenizer.processStream(consumedInput.data(), consumedInput.data() + consumedInput.size(), std::make_shared<TextLocation>()).size();
+	});
+
+	return 0;
+}
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// the generator scalability suite astir_scalability runs (see CMakeLists.txt)
+// it synthesizes grammars of every family below for a growing size N, has astir generate each of them from scratch with `--stats`,
+// fits the growth of the wall time of the measured phases in N (the exponent of the power law through the measurements, on a log-log scale),
+// and fails should any of them grow faster than the complexity its family declares
+// usage: astir_scalability <astir executable> <scratch directory> [size multiplier, 1 by default]
+// astir has to be run from a directory containing its Resources, as always
+
+// measurements shorter than that are mostly noise, and are left out of the fits
+static const double MIN_MEASURED_SECONDS = 0.002;
+// the fitted exponents may exceed the declared ones by this much before failing, the fits being rough with only a few sizes measured
+static const double EXPONENT_TOLERANCE = 0.4;
+// every size is generated this many times, the fastest run being taken
+static const int RUNS_PER_SIZE = 3;
+
+struct Family {
+	std::string name;
+	std::string description;
+	std::function<std::string(size_t)> synthesize; // the grammar of size N
+	std::vector<size_t> sizes;
+	std::vector<std::pair<std::string, double>> bounds; // the measured phases of --stats and the exponents of their declared complexities
+};
+
+// a distinct lowercase word for every index, none of them a prefix of another one of the same length
+std::string word(size_t index) {
+	std::string ret;
+	do {
+		ret += (char)('a' + index % 26);
+		index /= 26;
+	} while (index > 0);
+	return ret;
+}
+
+// a tokenizer of N literal tokens T0 .. T(N-1), for the parsers to be on
+std::string literalTokenizer(const std::string& name, size_t tokenCount) {
+	std::stringstream ss;
+	ss << "finite automaton " << name << " {" << std::endl;
+	ss << "    ignored root WhiteSpace = ' '+;" << std::endl;
+	for (size_t tokenIndex = 0; tokenIndex < tokenCount; ++tokenIndex) {
+		ss << "    root T" << tokenIndex << " = \"t" << word(tokenIndex) << "\";" << std::endl;
+	}
+	ss << "}" << std::endl;
+	return ss.str();
+}
+
+std::vector<Family> families(size_t multiplier) {
+	auto scaled = [multiplier](std::vector<size_t> sizes) {
+		for (auto& size : sizes) {
+			size *= multiplier;
+		}
+		return sizes;
+	};
+
+	std::vector<Family> ret;
+	ret.push_back({ "literals", "a finite automaton of N literal tokens", [](size_t n) {
+		std::stringstream ss;
+		ss << "finite automaton Literals {" << std::endl;
+		ss << "    ignored root WhiteSpace = ' '+;" << std::endl;
+		for (size_t literalIndex = 0; literalIndex < n; ++literalIndex) {
+			ss << "    root L" << literalIndex << " = \"l" << word(literalIndex) << "x\";" << std::endl;
+		}
+		ss << "}" << std::endl;
+		return ss.str();
+	}, scaled({ 100, 200, 400, 800 }), { { "pseudoDFABuilding", 2.0 }, { "emission", 1.0 } } });
+
+	ret.push_back({ "repetitions", "a finite automaton of a token of between N/2 and N repetitions of an alternation", [](size_t n) {
+		std::stringstream ss;
+		ss << "finite automaton Repetitions {" << std::endl;
+		ss << "    ignored root WhiteSpace = ' '+;" << std::endl;
+		ss << "    root R = ('a' | 'b' 'c'){" << n / 2 << "," << n << "} 'd';" << std::endl;
+		ss << "}" << std::endl;
+		return ss.str();
+	}, scaled({ 50, 100, 200, 400 }), { { "pseudoDFABuilding", 2.0 }, { "emission", 1.0 } } });
+
+	ret.push_back({ "alternatives", "an LL(1) parser of a production of N alternatives", [](size_t n) {
+		std::stringstream ss;
+		ss << literalTokenizer("AlternativesTokenizer", n);
+		ss << "LL(1) parser Alternatives on AlternativesTokenizer {" << std::endl;
+		ss << "    root production Choice =" << std::endl;
+		for (size_t alternativeIndex = 0; alternativeIndex < n; ++alternativeIndex) {
+			ss << "        " << (alternativeIndex > 0 ? "| " : "") << "T" << alternativeIndex << " T" << (alternativeIndex + 1) % n << std::endl;
+		}
+		ss << "        ;" << std::endl;
+		ss << "}" << std::endl;
+		return ss.str();
+	}, scaled({ 50, 100, 200, 400 }), { { "llkBuilding", 2.0 }, { "emission", 1.0 } } });
+
+	ret.push_back({ "categoryNesting", "an LL(1) parser of N categories nested into each other, each with a production of its own", [](size_t n) {
+		std::stringstream ss;
+		ss << literalTokenizer("NestingTokenizer", n);
+		ss << "LL(1) parser Nesting on NestingTokenizer {" << std::endl;
+		ss << "    root category C0;" << std::endl;
+		for (size_t categoryIndex = 1; categoryIndex < n; ++categoryIndex) {
+			ss << "    category C" << categoryIndex << " : C" << categoryIndex - 1 << ";" << std::endl;
+		}
+		for (size_t categoryIndex = 0; categoryIndex < n; ++categoryIndex) {
+			ss << "    production P" << categoryIndex << " : C" << categoryIndex << " = T" << categoryIndex << ";" << std::endl;
+		}
+		ss << "}" << std::endl;
+		return ss.str();
+	}, scaled({ 25, 50, 100, 200 }), { { "llkBuilding", 3.0 }, { "emission", 2.0 } } });
+
+	return ret;
+}
+
+// the number of seconds --stats reports for the phase, negative if there is none
+double readPhaseSeconds(const std::string& statistics, const std::string& phase) {
+	std::smatch match;
+	if (!std::regex_search(statistics, match, std::regex("\"" + phase + "\": ([0-9.eE+-]+)"))) {
+		return -1.0;
+	}
+	return std::stod(match[1].str());
+}
+
+// the slope of the least-squares line through the points (log N, log seconds)
+double fitExponent(const std::vector<std::pair<size_t, double>>& measurements) {
+	double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+	for (const auto& measurement : measurements) {
+		const double x = std::log((double)measurement.first);
+		const double y = std::log(measurement.second);
+		sumX += x;
+		sumY += y;
+		sumXX += x * x;
+		sumXY += x * y;
+	}
+	const double count = (double)measurements.size();
+	return (count * sumXY - sumX * sumY) / (count * sumXX - sumX * sumX);
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cerr << "usage: " << argv[0] << " <astir executable> <scratch directory> [size multiplier]" << std::endl;
+		return 2;
+	}
+	const std::string astirPath = argv[1];
+	const std::filesystem::path scratchPath = argv[2];
+	const size_t multiplier = argc > 3 ? std::max(std::atoi(argv[3]), 1) : 1;
+
+	bool allWithinBounds = true;
+	for (const Family& family : families(multiplier)) {
+		std::cout << family.name << ": " << family.description << std::endl;
+		const std::filesystem::path familyPath = scratchPath / family.name;
+		std::filesystem::create_directories(familyPath);
+
+		std::vector<std::vector<std::pair<size_t, double>>> measurements(family.bounds.size());
+		for (size_t n : family.sizes) {
+			const std::filesystem::path grammarPath = familyPath / (std::to_string(n) + ".astir");
+			std::ofstream(grammarPath) << family.synthesize(n);
+
+			std::vector<double> fastest(family.bounds.size(), -1.0);
+			for (int run = 0; run < RUNS_PER_SIZE; ++run) {
+				// a fresh output directory every time, so that nothing is up to date or cached
+				const std::filesystem::path outputPath = familyPath / std::to_string(n);
+				const std::filesystem::path statisticsPath = familyPath / (std::to_string(n) + ".json");
+				std::filesystem::remove_all(outputPath);
+				std::filesystem::remove(statisticsPath);
+				const std::string command = "\"" + astirPath + "\" \"" + grammarPath.string() + "\" --outputDirectory \"" + outputPath.string() + "\" --stats \"" + statisticsPath.string() + "\" --jobs 1 > \"" + (familyPath / "astir.log").string() + "\"";
+				const int exitCode = std::system(command.c_str());
+
+				std::ifstream statisticsFile(statisticsPath);
+				if (exitCode != 0 || !statisticsFile) {
+					std::cerr << "  generating " << grammarPath.string() << " failed, see " << (familyPath / "astir.log").string() << std::endl;
+					return 1;
+				}
+				std::stringstream statistics;
+				statistics << statisticsFile.rdbuf();
+
+				for (size_t boundIndex = 0; boundIndex < family.bounds.size(); ++boundIndex) {
+					const double seconds = readPhaseSeconds(statistics.str(), family.bounds[boundIndex].first);
+					if (fastest[boundIndex] < 0.0 || seconds < fastest[boundIndex]) {
+						fastest[boundIndex] = seconds;
+					}
+				}
+			}
+
+			std::cout << "  N = " << std::setw(6) << n;
+			for (size_t boundIndex = 0; boundIndex < family.bounds.size(); ++boundIndex) {
+				std::cout << std::setw(20) << family.bounds[boundIndex].first << std::fixed << std::setprecision(4) << std::setw(10) << fastest[boundIndex] << " s";
+				if (fastest[boundIndex] >= MIN_MEASURED_SECONDS) {
+					measurements[boundIndex].emplace_back(n, fastest[boundIndex]);
+				}
+			}
+			std::cout << std::endl;
+		}
+
+		for (size_t boundIndex = 0; boundIndex < family.bounds.size(); ++boundIndex) {
+			const std::string& phase = family.bounds[boundIndex].first;
+			const double declaredExponent = family.bounds[boundIndex].second;
+			std::cout << "  " << std::left << std::setw(20) << phase << std::right << "declared O(N^" << std::setprecision(1) << declaredExponent << "), ";
+			if (measurements[boundIndex].size() < 2) {
+				std::cout << "too fast to tell" << std::endl;
+				continue;
+			}
+
+			const double exponent = fitExponent(measurements[boundIndex]);
+			const bool withinBound = exponent <= declaredExponent + EXPONENT_TOLERANCE;
+			std::cout << "observed N^" << std::setprecision(2) << exponent << (withinBound ? "" : " -- EXCEEDS THE BOUND") << std::endl;
+			allWithinBounds = allWithinBounds && withinBound;
+		}
+	}
+
+	if (!allWithinBounds) {
+		std::cerr << "The generation time grows faster than declared for some of the grammars" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,145 @@
+#include "CategoryClosure.h"
+
+#include "MachineDefinition.h"
+#include "MachineStatement.h"
+
+void CategoryClosure::build(const MachineDefinition& machine) {
+	m_indices.clear();
+	m_statements.clear();
+	m_referals.clear();
+	m_instandingProductions.clear();
+
+	std::set<const MachineDefinition*> machinesEnlisted;
+	enlistMachine(machine, machinesEnlisted);
+
+	m_referals.assign(m_statements.size(), StatementBitset(m_statements.size(), false));
+	m_instandingProductions.resize(m_statements.size());
+	std::vector<bool> closed(m_statements.size(), false);
+	for (size_t index = 0; index < m_statements.size(); ++index) {
+		close(index, closed);
+	}
+}
+
+bool CategoryClosure::categoricallyRefersTo(const AttributedStatement* referrer, const AttributedStatement* referee) const {
+	size_t referrerIndex, refereeIndex;
+	if (!indexOf(referrer, referrerIndex) || !indexOf(referee, refereeIndex)) {
+		return referrer->categoricallyRefersTo(referee);
+	}
+
+	return m_referals[referrerIndex][refereeIndex];
+}
+
+std::set<const AttributedStatement*> CategoryClosure::unpickReferal(const AttributedStatement* referrer, const AttributedStatement* referee) const {
+	if (!categoricallyRefersTo(referrer, referee)) {
+		return std::set<const AttributedStatement*>({ referrer });
+	}
+
+	const CategoryStatement* referrerAsCategory = dynamic_cast<const CategoryStatement*>(referrer);
+	if (referrerAsCategory == nullptr) {
+		return referrer->unpickReferal(referee);
+	}
+
+	std::set<const AttributedStatement*> ret;
+	for (const auto& referencePair : referrerAsCategory->references) {
+		if (referencePair.second.statement != referee) {
+			auto subUnpicked = unpickReferal(referencePair.second.statement, referee);
+			ret.insert(subUnpicked.cbegin(), subUnpicked.cend());
+		}
+	}
+	return ret;
+}
+
+std::list<const ProductionStatement*> CategoryClosure::calculateInstandingProductions(const AttributedStatement* statement) const {
+	size_t index;
+	if (!indexOf(statement, index)) {
+		return statement->calculateInstandingProductions();
+	}
+
+	return m_instandingProductions[index];
+}
+
+void CategoryClosure::enlistMachine(const MachineDefinition& machine, std::set<const MachineDefinition*>& machinesEnlisted) {
+	if (!machinesEnlisted.insert(&machine).second) {
+		return;
+	}
+
+	for (const auto& usedPair : machine.uses) {
+		if (usedPair.second) {
+			enlistMachine(*usedPair.second, machinesEnlisted);
+		}
+	}
+	if (machine.on.second) {
+		enlistMachine(*machine.on.second, machinesEnlisted);
+	}
+
+	for (const auto& statementPair : machine.statements) {
+		auto attributedStatementPtr = dynamic_cast<const AttributedStatement*>(statementPair.second.get());
+		if (attributedStatementPtr != nullptr) {
+			enlist(attributedStatementPtr);
+		}
+	}
+}
+
+size_t CategoryClosure::enlist(const AttributedStatement* statement) {
+	auto fit = m_indices.find(statement);
+	if (fit != m_indices.end()) {
+		return fit->second;
+	}
+
+	const size_t index = m_statements.size();
+	m_indices.emplace(statement, index);
+	m_statements.push_back(statement);
+
+	// categories may well be referred to by statements of machines other than the one they were declared in
+	const CategoryStatement* statementAsCategory = dynamic_cast<const CategoryStatement*>(statement);
+	if (statementAsCategory != nullptr) {
+		for (const auto& referencePair : statementAsCategory->references) {
+			enlist(referencePair.second.statement);
+		}
+	}
+
+	return index;
+}
+
+void CategoryClosure::close(size_t index, std::vector<bool>& closed) {
+	if (closed[index]) {
+		return;
+	}
+	closed[index] = true;
+
+	const AttributedStatement* statement = m_statements[index];
+	const CategoryStatement* statementAsCategory = dynamic_cast<const CategoryStatement*>(statement);
+	if (statementAsCategory == nullptr) {
+		// productions and patterns refer only to themselves
+		m_referals[index][index] = true;
+		m_instandingProductions[index] = statement->calculateInstandingProductions();
+		return;
+	}
+
+	// the category hierarchy was verified to be free of recursion, so the children are always closed before their parent
+	StatementBitset& referals = m_referals[index];
+	for (const auto& referencePair : statementAsCategory->references) {
+		const size_t referenceIndex = m_indices.at(referencePair.second.statement);
+		close(referenceIndex, closed);
+
+		const StatementBitset& referenceReferals = m_referals[referenceIndex];
+		for (size_t bit = 0; bit < referals.size(); ++bit) {
+			if (referenceReferals[bit]) {
+				referals[bit] = true;
+			}
+		}
+
+		const auto& referenceProductions = m_instandingProductions[referenceIndex];
+		m_instandingProductions[index].insert(m_instandingProductions[index].end(), referenceProductions.cbegin(), referenceProductions.cend());
+	}
+}
+
+bool CategoryClosure::indexOf(const AttributedStatement* statement, size_t& index) const {
+	auto fit = m_indices.find(statement);
+	if (fit == m_indices.end()) {
+		return false;
+	}
+
+	index = fit->second;
+	return true;
+}
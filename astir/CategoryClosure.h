@@ -0,0 +1,37 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <list>
+#include <vector>
+#include <cstddef>
+
+struct AttributedStatement;
+struct ProductionStatement;
+struct MachineDefinition;
+
+using StatementBitset = std::vector<bool>;
+
+/*
+	The transitive closure of the category hierarchy as seen from a single machine, i.e. from its own statements and those of its `on` and `uses` dependencies.
+	Computed once per machine initialization so that the symbol group comparisons done by NFA determinization and LL(k) disambiguation
+	don't have to walk the category hierarchy recursively every time.
+*/
+struct CategoryClosure {
+	void build(const MachineDefinition& machine);
+
+	bool categoricallyRefersTo(const AttributedStatement* referrer, const AttributedStatement* referee) const;
+	std::set<const AttributedStatement*> unpickReferal(const AttributedStatement* referrer, const AttributedStatement* referee) const;
+	std::list<const ProductionStatement*> calculateInstandingProductions(const AttributedStatement* statement) const;
+
+private:
+	std::map<const AttributedStatement*, size_t> m_indices;
+	std::vector<const AttributedStatement*> m_statements;
+	std::vector<StatementBitset> m_referals; // for every statement, the (non-category) statements it categorically refers to
+	std::vector<std::list<const ProductionStatement*>> m_instandingProductions;
+
+	void enlistMachine(const MachineDefinition& machine, std::set<const MachineDefinition*>& machinesEnlisted);
+	size_t enlist(const AttributedStatement* statement);
+	void close(size_t index, std::vector<bool>& closed);
+	bool indexOf(const AttributedStatement* statement, size_t& index) const;
+};
@@ -0,0 +1,82 @@
+#include "ConstructionCache.h"
+
+#include "ConstructionSerializer.h"
+#include "ConstructionCacheException.h"
+#include "GenerationHelper.h"
+#include "SyntacticTree.h"
+#include "MachineDefinition.h"
+
+void ConstructionCache::load(const SyntacticTree* tree) {
+	m_records.clear();
+	if (!std::filesystem::exists(m_filePath)) {
+		return;
+	}
+
+	const std::string data = GenerationHelper::readFile(m_filePath, true);
+	const std::string magic(MAGIC);
+	if (data.compare(0, magic.size(), magic) != 0) {
+		return;
+	}
+
+	const std::string body = data.substr(magic.size());
+	try {
+		ConstructionReader reader(body);
+		if (reader.readSize() != FORMAT_VERSION) {
+			// written by some other version of the generator, everything needs to be built anew
+			return;
+		}
+
+		std::map<std::string, Record> records;
+		uint64_t recordCount = reader.readSize();
+		for (uint64_t recordIndex = 0; recordIndex < recordCount; ++recordIndex) {
+			std::string machineName = reader.readString();
+			Record& record = records[machineName];
+			record.fingerprint = reader.readSize();
+			record.construction = reader.readString();
+		}
+		m_records = std::move(records);
+	} catch (const ConstructionCacheException&) {
+		// a damaged cache is no cache
+		return;
+	}
+
+	for (const auto& recordPair : m_records) {
+		auto machineIt = tree->machineDefinitions.find(recordPair.first);
+		if (machineIt != tree->machineDefinitions.end() && recordPair.second.fingerprint == tree->machineFingerprint(recordPair.first)) {
+			machineIt->second->provideCachedConstruction(recordPair.second.construction);
+		}
+	}
+}
+
+void ConstructionCache::store(const SyntacticTree* tree) const {
+	ConstructionWriter writer;
+	std::map<std::string, Record> records;
+	for (const auto& machineDefinitionPair : tree->machineDefinitions) {
+		const std::string& machineName = machineDefinitionPair.first;
+		const Fingerprint fingerprint = tree->machineFingerprint(machineName);
+
+		// up-to-date machines have not been built, so whatever has been cached for them is kept
+		if (machineDefinitionPair.second->isUpToDate()) {
+			auto recordIt = m_records.find(machineName);
+			if (recordIt != m_records.cend() && recordIt->second.fingerprint == fingerprint) {
+				records.emplace(machineName, recordIt->second);
+			}
+			continue;
+		}
+
+		ConstructionWriter machineWriter;
+		if (machineDefinitionPair.second->storeConstruction(machineWriter)) {
+			records.emplace(machineName, Record{ fingerprint, machineWriter.data() });
+		}
+	}
+
+	writer.writeSize(FORMAT_VERSION);
+	writer.writeSize(records.size());
+	for (const auto& recordPair : records) {
+		writer.writeString(recordPair.first);
+		writer.writeSize(recordPair.second.fingerprint);
+		writer.writeString(recordPair.second.construction);
+	}
+
+	GenerationHelper::writeFileIfChanged(m_filePath, std::string(MAGIC) + writer.data(), true);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Fingerprint.h"
+
+#include <string>
+#include <map>
+#include <filesystem>
+
+struct SyntacticTree;
+
+/*
+	The on-disk cache of what the machines have been built into (see ConstructionSerializer), so that the automata and decision trees of machines whose definitions have not changed are not built anew.
+	The file starts with the magic "ASTIRC" followed by the format version and then lists the machines, each by its name, fingerprint (of the definition along with its dependencies) and serialized construction.
+	The version is to be bumped whenever the format or anything about how the machines are built changes.
+*/
+class ConstructionCache {
+public:
+	ConstructionCache(const std::filesystem::path& filePath)
+		: m_filePath(filePath) { }
+
+	void load(const SyntacticTree* tree); // hands the cached constructions whose fingerprints still match over to the machines
+	void store(const SyntacticTree* tree) const;
+
+private:
+	static constexpr const char* MAGIC = "ASTIRC";
+	static constexpr uint64_t FORMAT_VERSION = 3;
+
+	struct Record {
+		Fingerprint fingerprint;
+		std::string construction;
+	};
+
+	std::filesystem::path m_filePath;
+	std::map<std::string, Record> m_records;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Exception.h"
+
+class ConstructionCacheException : public Exception {
+public:
+	ConstructionCacheException(const std::string& message)
+		: Exception(message) { }
+};
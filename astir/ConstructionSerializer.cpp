@@ -0,0 +1,502 @@
+#include "ConstructionSerializer.h"
+
+#include "ConstructionCacheException.h"
+#include "LLkParserDefinition.h"
+#include "MachineStatement.h"
+#include "Field.h"
+
+#include <set>
+
+namespace {
+	enum class SymbolGroupTag : uint8_t {
+		None = 0,
+		Empty = 1,
+		Byte = 2,
+		Literal = 3,
+		Statement = 4
+	};
+
+	enum class FieldTag : uint8_t {
+		None = 0,
+		Flag = 1,
+		Raw = 2,
+		Item = 3,
+		List = 4
+	};
+
+	constexpr uint64_t NO_FIRSTABLE = (uint64_t)-1;
+}
+
+LLkFirstableIndex::LLkFirstableIndex(const LLkParserDefinition& machine) {
+	for (const auto& statementPair : machine.statements) {
+		enlist(statementPair.second.get());
+
+		auto ruleStatement = dynamic_cast<const RuleStatement*>(statementPair.second.get());
+		if (ruleStatement && ruleStatement->regex) {
+			enlistRegex(ruleStatement->regex.get());
+		}
+	}
+
+	// the statements of the dependencies may be referred to by categories and references, but their regexes are of no concern to this machine
+	std::set<const MachineDefinition*> machinesEnlisted({ &machine });
+	std::list<const MachineDefinition*> machinesToEnlist;
+	if (machine.on.second) {
+		machinesToEnlist.push_back(machine.on.second.get());
+	}
+	for (const auto& usedPair : machine.uses) {
+		machinesToEnlist.push_back(usedPair.second.get());
+	}
+	while (!machinesToEnlist.empty()) {
+		const MachineDefinition* dependency = machinesToEnlist.front();
+		machinesToEnlist.pop_front();
+		if (!machinesEnlisted.insert(dependency).second) {
+			continue;
+		}
+
+		enlistStatements(*dependency);
+		if (dependency->on.second) {
+			machinesToEnlist.push_back(dependency->on.second.get());
+		}
+		for (const auto& usedPair : dependency->uses) {
+			machinesToEnlist.push_back(usedPair.second.get());
+		}
+	}
+}
+
+bool LLkFirstableIndex::find(ILLkFirstableCPtr firstable, uint64_t& id) const {
+	auto it = m_ids.find(firstable);
+	if (it == m_ids.cend()) {
+		return false;
+	}
+
+	id = it->second;
+	return true;
+}
+
+ILLkFirstableCPtr LLkFirstableIndex::at(uint64_t id) const {
+	if (id >= m_firstables.size()) {
+		return nullptr;
+	}
+
+	return m_firstables[id];
+}
+
+void LLkFirstableIndex::enlist(ILLkFirstableCPtr firstable) {
+	if (firstable == nullptr || m_ids.find(firstable) != m_ids.cend()) {
+		return;
+	}
+
+	m_ids.emplace(firstable, (uint64_t)m_firstables.size());
+	m_firstables.push_back(firstable);
+}
+
+void LLkFirstableIndex::enlistStatements(const MachineDefinition& machine) {
+	for (const auto& statementPair : machine.statements) {
+		enlist(statementPair.second.get());
+	}
+}
+
+void LLkFirstableIndex::enlistRegex(const Regex* regex) {
+	enlist(dynamic_cast<ILLkFirstableCPtr>(regex));
+
+	if (auto disjunctiveRegex = dynamic_cast<const DisjunctiveRegex*>(regex)) {
+		for (const auto& conjunction : disjunctiveRegex->disjunction) {
+			enlistRegex(conjunction.get());
+		}
+	} else if (auto conjunctiveRegex = dynamic_cast<const ConjunctiveRegex*>(regex)) {
+		for (const auto& rootRegex : conjunctiveRegex->conjunction) {
+			enlistRegex(rootRegex.get());
+		}
+	} else if (auto repetitiveRegex = dynamic_cast<const RepetitiveRegex*>(regex)) {
+		enlistRegex(repetitiveRegex->regex.get());
+		if (repetitiveRegex->maxRepetitions == RepetitiveRegex::INFINITE_REPETITIONS) {
+			enlist(repetitiveRegex->kleeneTail().get());
+		}
+	}
+}
+
+void ConstructionWriter::writeByte(uint8_t byte) {
+	m_data.push_back((char)byte);
+}
+
+void ConstructionWriter::writeSize(uint64_t size) {
+	// little-endian, regardless of the platform
+	for (int byteIndex = 0; byteIndex < 8; ++byteIndex) {
+		writeByte((uint8_t)(size >> (8 * byteIndex)));
+	}
+}
+
+void ConstructionWriter::writeString(const std::string& str) {
+	writeSize(str.size());
+	m_data += str;
+}
+
+void ConstructionWriter::writeSymbolGroup(const std::shared_ptr<SymbolGroup>& symbolGroup) {
+	if (!symbolGroup) {
+		writeByte((uint8_t)SymbolGroupTag::None);
+	} else if (auto byteSymbolGroup = std::dynamic_pointer_cast<ByteSymbolGroup>(symbolGroup)) {
+		writeByte((uint8_t)SymbolGroupTag::Byte);
+		writeByte(byteSymbolGroup->rangeStart);
+		writeByte(byteSymbolGroup->rangeEnd);
+	} else if (auto literalSymbolGroup = std::dynamic_pointer_cast<LiteralSymbolGroup>(symbolGroup)) {
+		writeByte((uint8_t)SymbolGroupTag::Literal);
+		writeString(literalSymbolGroup->literal);
+	} else if (auto statementSymbolGroup = std::dynamic_pointer_cast<StatementSymbolGroup>(symbolGroup)) {
+		writeByte((uint8_t)SymbolGroupTag::Statement);
+		writeString(statementSymbolGroup->statement->name);
+		writeString(statementSymbolGroup->statementMachine->name);
+	} else {
+		writeByte((uint8_t)SymbolGroupTag::Empty);
+	}
+}
+
+void ConstructionWriter::writeActionRegister(const NFAActionRegister& actionRegister) {
+	writeSize(actionRegister.size());
+	for (const auto& action : actionRegister) {
+		writeByte((uint8_t)action.type);
+		writeString(action.contextPath);
+		writeString(action.targetName);
+		writeString(action.payload);
+		writeField(action.targetField);
+	}
+}
+
+void ConstructionWriter::writeNFA(const NFA& nfa) {
+	writeSize(nfa.states.size());
+	for (const auto& state : nfa.states) {
+		writeActionRegister(state.actions);
+		writeSize(state.transitions.size());
+		for (const auto& transition : state.transitions) {
+			writeSize(transition.target);
+			writeSymbolGroup(transition.condition);
+			writeActionRegister(transition.actions);
+			writeByte(transition.doNotOptimizeTargetIntoSymbolClosure ? 1 : 0);
+		}
+	}
+
+	writeSize(nfa.finalStates.size());
+	for (State finalState : nfa.finalStates) {
+		writeSize(finalState);
+	}
+
+	writeSize(nfa.contexts.size());
+	for (const auto& contextPair : nfa.contexts) {
+		writeString(contextPair.first);
+		writeString(contextPair.second);
+	}
+}
+
+bool ConstructionWriter::writeFlyweights(const std::map<ILLkNonterminalCPtr, LLkFlyweight>& flyweights, const LLkFirstableIndex& index) {
+	ConstructionWriter flyweightWriter;
+	flyweightWriter.writeSize(flyweights.size());
+	for (const auto& flyweightPair : flyweights) {
+		if (!flyweightWriter.writeFirstable(flyweightPair.first, index)) {
+			return false;
+		}
+
+		flyweightWriter.writeSize(flyweightPair.second.contexts.size());
+		for (const auto& context : flyweightPair.second.contexts) {
+			if (context.parent == nullptr) {
+				flyweightWriter.writeSize(NO_FIRSTABLE);
+			} else if (!flyweightWriter.writeFirstable(context.parent, index)) {
+				return false;
+			}
+
+			flyweightWriter.writeSize(context.followedBy.size());
+			for (ILLkFirstableCPtr follower : context.followedBy) {
+				if (!flyweightWriter.writeFirstable(follower, index)) {
+					return false;
+				}
+			}
+		}
+
+		if (!flyweightWriter.writeDecisionPoint(flyweightPair.second.decisions)) {
+			return false;
+		}
+	}
+
+	m_data += flyweightWriter.m_data;
+	return true;
+}
+
+void ConstructionWriter::writeField(const std::shared_ptr<Field>& field) {
+	if (!field) {
+		writeByte((uint8_t)FieldTag::None);
+		return;
+	}
+
+	auto variablyTypedField = std::dynamic_pointer_cast<VariablyTypedField>(field);
+	if (std::dynamic_pointer_cast<FlagField>(field)) {
+		writeByte((uint8_t)FieldTag::Flag);
+	} else if (std::dynamic_pointer_cast<RawField>(field)) {
+		writeByte((uint8_t)FieldTag::Raw);
+	} else if (std::dynamic_pointer_cast<ItemField>(field)) {
+		writeByte((uint8_t)FieldTag::Item);
+	} else {
+		writeByte((uint8_t)FieldTag::List);
+	}
+
+	writeString(field->name);
+	if (variablyTypedField) {
+		writeString(variablyTypedField->type);
+		writeString(variablyTypedField->machineOfTheType ? variablyTypedField->machineOfTheType->name : std::string());
+	}
+}
+
+bool ConstructionWriter::writeFirstable(ILLkFirstableCPtr firstable, const LLkFirstableIndex& index) {
+	uint64_t id;
+	if (!index.find(firstable, id)) {
+		return false;
+	}
+
+	writeSize(id);
+	return true;
+}
+
+bool ConstructionWriter::writeDecisionPoint(const LLkDecisionPoint& point) {
+	writeSize(point.transitions.size());
+	for (const auto& transition : point.transitions) {
+		writeSymbolGroup(transition->condition);
+		if (!writeDecisionPoint(transition->point)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint8_t ConstructionReader::readByte() {
+	if (m_position >= m_data.size()) {
+		throw ConstructionCacheException("Unexpected end of the construction data");
+	}
+
+	return (uint8_t)m_data[m_position++];
+}
+
+uint64_t ConstructionReader::readSize() {
+	uint64_t size = 0;
+	for (int byteIndex = 0; byteIndex < 8; ++byteIndex) {
+		size |= (uint64_t)readByte() << (8 * byteIndex);
+	}
+	return size;
+}
+
+std::string ConstructionReader::readString() {
+	uint64_t size = readSize();
+	if (size > m_data.size() - m_position) {
+		throw ConstructionCacheException("Unexpected end of the construction data");
+	}
+
+	std::string ret = m_data.substr(m_position, (size_t)size);
+	m_position += (size_t)size;
+	return ret;
+}
+
+std::shared_ptr<SymbolGroup> ConstructionReader::readSymbolGroup() {
+	switch ((SymbolGroupTag)readByte()) {
+		case SymbolGroupTag::None:
+			return nullptr;
+		case SymbolGroupTag::Empty:
+			return std::make_shared<EmptySymbolGroup>();
+		case SymbolGroupTag::Byte: {
+			CharType rangeStart = readByte();
+			CharType rangeEnd = readByte();
+			return std::make_shared<ByteSymbolGroup>(rangeStart, rangeEnd);
+		}
+		case SymbolGroupTag::Literal:
+			return std::make_shared<LiteralSymbolGroup>(readString());
+		case SymbolGroupTag::Statement: {
+			std::string statementName = readString();
+			std::string machineName = readString();
+			const MachineDefinition* statementMachine = findMachine(machineName);
+			if (statementMachine == nullptr) {
+				throw ConstructionCacheException("The machine '" + machineName + "' is no longer a dependency of '" + contextName() + "'");
+			}
+
+			auto statementIt = statementMachine->statements.find(statementName);
+			const TypeFormingStatement* statement = statementIt == statementMachine->statements.cend() ? nullptr : dynamic_cast<const TypeFormingStatement*>(statementIt->second.get());
+			if (statement == nullptr) {
+				throw ConstructionCacheException("The type-forming statement '" + statementName + "' could not be found in the machine '" + machineName + "'");
+			}
+
+			return std::make_shared<StatementSymbolGroup>(statement, statementMachine, &m_context->categoryClosure());
+		}
+		default:
+			throw ConstructionCacheException("Unknown symbol group tag in the construction data");
+	}
+}
+
+NFAActionRegister ConstructionReader::readActionRegister() {
+	NFAActionRegister ret;
+	uint64_t actionCount = readSize();
+	for (uint64_t actionIndex = 0; actionIndex < actionCount; ++actionIndex) {
+		NFAActionType type = (NFAActionType)readByte();
+		std::string contextPath = readString();
+		std::string targetName = readString();
+		std::string payload = readString();
+		ret.emplace_back(type, contextPath, targetName, readField(), payload);
+	}
+	return ret;
+}
+
+NFA ConstructionReader::readNFA() {
+	NFA ret;
+	ret.states.clear();
+
+	uint64_t stateCount = readSize();
+	for (uint64_t stateIndex = 0; stateIndex < stateCount; ++stateIndex) {
+		NFAState state;
+		state.actions = readActionRegister();
+		uint64_t transitionCount = readSize();
+		for (uint64_t transitionIndex = 0; transitionIndex < transitionCount; ++transitionIndex) {
+			State target = (State)readSize();
+			if (target >= stateCount) {
+				throw ConstructionCacheException("Transition to a nonexistent state in the construction data");
+			}
+			auto condition = readSymbolGroup();
+			NFAActionRegister actions = readActionRegister();
+			bool doNotOptimizeTargetIntoSymbolClosure = readByte() != 0;
+			state.transitions.emplace_back(target, condition, actions, doNotOptimizeTargetIntoSymbolClosure);
+		}
+		ret.states.push_back(std::move(state));
+	}
+
+	uint64_t finalStateCount = readSize();
+	for (uint64_t finalStateIndex = 0; finalStateIndex < finalStateCount; ++finalStateIndex) {
+		State finalState = (State)readSize();
+		if (finalState >= stateCount) {
+			throw ConstructionCacheException("Nonexistent final state in the construction data");
+		}
+		ret.finalStates.insert(finalState);
+	}
+
+	uint64_t contextCount = readSize();
+	for (uint64_t contextIndex = 0; contextIndex < contextCount; ++contextIndex) {
+		std::string parentContextName = readString();
+		ret.contexts.emplace_back(parentContextName, readString());
+	}
+
+	return ret;
+}
+
+std::map<ILLkNonterminalCPtr, LLkFlyweight> ConstructionReader::readFlyweights(const LLkFirstableIndex& index) {
+	std::map<ILLkNonterminalCPtr, LLkFlyweight> ret;
+	uint64_t flyweightCount = readSize();
+	for (uint64_t flyweightIndex = 0; flyweightIndex < flyweightCount; ++flyweightIndex) {
+		LLkFlyweight& flyweight = ret[readNonterminal(index)];
+
+		uint64_t contextCount = readSize();
+		for (uint64_t contextIndex = 0; contextIndex < contextCount; ++contextIndex) {
+			LLkNonterminalContext context(readNonterminal(index));
+			uint64_t followerCount = readSize();
+			for (uint64_t followerIndex = 0; followerIndex < followerCount; ++followerIndex) {
+				context.followedBy.push_back(readFirstable(index));
+			}
+			flyweight.contexts.push_back(std::move(context));
+		}
+
+		flyweight.decisions = readDecisionPoint();
+	}
+	return ret;
+}
+
+std::shared_ptr<Field> ConstructionReader::readField() {
+	std::shared_ptr<Field> ret;
+	std::shared_ptr<VariablyTypedField> variablyTypedField;
+	switch ((FieldTag)readByte()) {
+		case FieldTag::None:
+			return nullptr;
+		case FieldTag::Flag:
+			ret = std::make_shared<FlagField>();
+			break;
+		case FieldTag::Raw:
+			ret = std::make_shared<RawField>();
+			break;
+		case FieldTag::Item:
+			ret = variablyTypedField = std::make_shared<ItemField>();
+			break;
+		case FieldTag::List:
+			ret = variablyTypedField = std::make_shared<ListField>();
+			break;
+		default:
+			throw ConstructionCacheException("Unknown field tag in the construction data");
+	}
+
+	ret->name = readString();
+	if (variablyTypedField) {
+		variablyTypedField->type = readString();
+		std::string machineName = readString();
+		if (!machineName.empty()) {
+			variablyTypedField->machineOfTheType = findMachine(machineName);
+			if (variablyTypedField->machineOfTheType == nullptr) {
+				throw ConstructionCacheException("The machine '" + machineName + "' is no longer a dependency of '" + contextName() + "'");
+			}
+		}
+	}
+
+	return ret;
+}
+
+ILLkFirstableCPtr ConstructionReader::readFirstable(const LLkFirstableIndex& index) {
+	ILLkFirstableCPtr ret = index.at(readSize());
+	if (ret == nullptr) {
+		throw ConstructionCacheException("Unknown grammar element in the construction data of '" + contextName() + "'");
+	}
+	return ret;
+}
+
+ILLkNonterminalCPtr ConstructionReader::readNonterminal(const LLkFirstableIndex& index) {
+	uint64_t id = readSize();
+	if (id == NO_FIRSTABLE) {
+		return nullptr;
+	}
+
+	ILLkNonterminalCPtr ret = dynamic_cast<ILLkNonterminalCPtr>(index.at(id));
+	if (ret == nullptr) {
+		throw ConstructionCacheException("Unknown nonterminal in the construction data of '" + contextName() + "'");
+	}
+	return ret;
+}
+
+LLkDecisionPoint ConstructionReader::readDecisionPoint() {
+	LLkDecisionPoint ret;
+	uint64_t transitionCount = readSize();
+	for (uint64_t transitionIndex = 0; transitionIndex < transitionCount; ++transitionIndex) {
+		auto condition = readSymbolGroup();
+		ret.transitions.push_back(std::make_shared<LLkTransition>(condition, readDecisionPoint()));
+	}
+	return ret;
+}
+
+const MachineDefinition* ConstructionReader::findMachine(const std::string& name) const {
+	if (m_context == nullptr) {
+		throw ConstructionCacheException("No machine to resolve the construction data against");
+	}
+
+	std::set<const MachineDefinition*> machinesVisited;
+	std::list<const MachineDefinition*> machinesToVisit({ m_context });
+	while (!machinesToVisit.empty()) {
+		const MachineDefinition* machine = machinesToVisit.front();
+		machinesToVisit.pop_front();
+		if (!machinesVisited.insert(machine).second) {
+			continue;
+		}
+
+		if (machine->name == name) {
+			return machine;
+		}
+
+		if (machine->on.second) {
+			machinesToVisit.push_back(machine->on.second.get());
+		}
+		for (const auto& usedPair : machine->uses) {
+			machinesToVisit.push_back(usedPair.second.get());
+		}
+	}
+
+	return nullptr;
+}
+
+std::string ConstructionReader::contextName() const {
+	return m_context ? m_context->name : std::string();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "NFA.h"
+#include "LLkBuilder.h"
+
+#include <cstdint>
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+
+struct MachineDefinition;
+struct LLkParserDefinition;
+struct Field;
+
+/*
+	A stable numbering of everything an LL(k) builder may key its flyweights on or mention in its contexts: the statements of the machine and of its dependencies,
+	and the regexes of the machine's own rules, including the tails of the kleene-starred repetitions.
+	The numbering only depends on the grammar, so that pointers of one run can be told apart by their numbers in another.
+*/
+class LLkFirstableIndex {
+public:
+	LLkFirstableIndex(const LLkParserDefinition& machine);
+
+	bool find(ILLkFirstableCPtr firstable, uint64_t& id) const;
+	ILLkFirstableCPtr at(uint64_t id) const;
+
+private:
+	std::vector<ILLkFirstableCPtr> m_firstables;
+	std::map<ILLkFirstableCPtr, uint64_t> m_ids;
+
+	void enlist(ILLkFirstableCPtr firstable);
+	void enlistStatements(const MachineDefinition& machine);
+	void enlistRegex(const Regex* regex);
+};
+
+/*
+	Binary serialization of the constructed internals of a machine, i.e. the pseudo-DFA of a finite automaton or the decision trees of an LL(k) parser.
+	The statements and fields the symbol groups and actions refer to are stored by name and resolved again against the machine the construction is read into.
+*/
+class ConstructionWriter {
+public:
+	void writeByte(uint8_t byte);
+	void writeSize(uint64_t size);
+	void writeString(const std::string& str);
+
+	void writeSymbolGroup(const std::shared_ptr<SymbolGroup>& symbolGroup);
+	void writeActionRegister(const NFAActionRegister& actionRegister);
+	void writeNFA(const NFA& nfa);
+	bool writeFlyweights(const std::map<ILLkNonterminalCPtr, LLkFlyweight>& flyweights, const LLkFirstableIndex& index); // false if some of the flyweights can not be indexed, nothing is written then
+
+	const std::string& data() const { return m_data; }
+
+private:
+	std::string m_data;
+
+	void writeField(const std::shared_ptr<Field>& field);
+	bool writeFirstable(ILLkFirstableCPtr firstable, const LLkFirstableIndex& index);
+	bool writeDecisionPoint(const LLkDecisionPoint& point);
+};
+
+// throws ConstructionCacheException whenever the data turn out to be malformed or not to match the machine, no machine is needed to read the plain sizes and strings
+class ConstructionReader {
+public:
+	ConstructionReader(const std::string& data, const MachineDefinition* context = nullptr)
+		: m_data(data), m_position(0), m_context(context) { }
+
+	uint8_t readByte();
+	uint64_t readSize();
+	std::string readString();
+
+	std::shared_ptr<SymbolGroup> readSymbolGroup();
+	NFAActionRegister readActionRegister();
+	NFA readNFA();
+	std::map<ILLkNonterminalCPtr, LLkFlyweight> readFlyweights(const LLkFirstableIndex& index);
+
+	bool atEnd() const { return m_position == m_data.size(); }
+
+private:
+	const std::string& m_data;
+	size_t m_position;
+	const MachineDefinition* m_context;
+
+	std::shared_ptr<Field> readField();
+	ILLkFirstableCPtr readFirstable(const LLkFirstableIndex& index);
+	ILLkNonterminalCPtr readNonterminal(const LLkFirstableIndex& index);
+	LLkDecisionPoint readDecisionPoint();
+	const MachineDefinition* findMachine(const std::string& name) const;
+	std::string contextName() const;
+};
@@ -0,0 +1,802 @@
+#include "CorpusGenerator.h"
+
+#include "GenerationException.h"
+#include "NFABuilder.h"
+#include "Regex.h"
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <stdexcept>
+
+CorpusGenerator::CorpusGenerator(const MachineDefinition& machine, uint64_t seed, const std::map<std::string, double>& weights)
+	: m_machine(machine), m_parser(dynamic_cast<const LLkParserDefinition*>(&machine)), m_weights(weights), m_random(seed) {
+	const MachineDefinition* topLevelMachine = m_parser != nullptr ? terminalMachine() : &machine;
+
+	// the weights may only refer to the statements of the machine and of those its terminals are rendered by
+	std::set<std::string> statementNames;
+	for (const auto& statementPair : machine.statements) {
+		statementNames.insert(statementPair.first);
+	}
+	for (const MachineDefinition* levelMachine = topLevelMachine; levelMachine != nullptr; levelMachine = levelMachine->on.second.get()) {
+		for (const auto& statementPair : levelMachine->statements) {
+			statementNames.insert(statementPair.first);
+		}
+	}
+	for (const auto& weightPair : m_weights) {
+		if (statementNames.count(weightPair.first) == 0) {
+			throw GenerationException("The corpus weight given to '" + weightPair.first + "' refers to nothing in '" + machine.name + "' or in the machines it reads the terminals of");
+		}
+	}
+
+	for (const MachineDefinition* levelMachine = topLevelMachine; levelMachine != nullptr; levelMachine = levelMachine->on.second.get()) {
+		auto finiteAutomaton = dynamic_cast<const FiniteAutomatonDefinition*>(levelMachine);
+		if (finiteAutomaton == nullptr) {
+			throw GenerationException("Corpora can only be generated for machines on raw input or on finite automata, and '" + machine.name + "' depends on the machine '" + levelMachine->name + "' that is not a finite automaton");
+		}
+		m_levels.push_back(std::make_unique<AutomatonLevel>(*finiteAutomaton, m_weights));
+	}
+
+	if (m_parser != nullptr) {
+		computeHeights();
+	}
+}
+
+std::string CorpusGenerator::generate(size_t byteCount) {
+	const auto parserRoots = m_machine.getRoots();
+	std::vector<double> rootWeights;
+	if (m_parser != nullptr) {
+		for (const auto& root : parserRoots) {
+			rootWeights.push_back(weightOf(root->name));
+		}
+		if (rootWeights.empty()) {
+			throw GenerationException("The machine '" + m_machine.name + "' has no roots to generate a corpus of");
+		}
+	} else {
+		for (size_t rootIndex = 0; rootIndex < m_levels.front()->rootCount(); ++rootIndex) {
+			rootWeights.push_back(m_levels.front()->rootWeight(rootIndex));
+		}
+	}
+
+	std::string ret;
+	ret.reserve(byteCount);
+	// the units (tokens of the automaton or sentences of the parser) generated last may be undone should nothing fit after them,
+	// so only the tokens stable already before the oldest of them are ever taken out of the levels
+	std::deque<std::vector<AutomatonLevel::Snapshot>> undoableUnits;
+	std::vector<SymbolIndex> stableSymbols;
+	auto takeStable = [this, &ret, &undoableUnits, &stableSymbols]() {
+		for (size_t levelIndex = 0; levelIndex < m_levels.size(); ++levelIndex) {
+			stableSymbols.clear();
+			const size_t tokenLimit = undoableUnits.empty() ? (size_t)-1 : undoableUnits.front()[levelIndex].unstableToken;
+			const AutomatonLevel::Snapshot taken = m_levels[levelIndex]->takeStable(stableSymbols, tokenLimit);
+			for (auto& unitSnapshots : undoableUnits) {
+				unitSnapshots[levelIndex].symbolCount -= taken.symbolCount;
+				unitSnapshots[levelIndex].tokenCount -= taken.tokenCount;
+				unitSnapshots[levelIndex].unstableToken -= taken.tokenCount;
+			}
+
+			// only the bytes at the bottom make it to the corpus, the symbols above have already been rendered in them
+			if (levelIndex + 1 == m_levels.size()) {
+				for (SymbolIndex symbol : stableSymbols) {
+					ret.push_back((char)(unsigned char)symbol);
+				}
+			}
+		}
+	};
+
+	// the generation progresses as long as more and more tokens become stable, anything else (e.g. a run of tokens that keep the last of them open to being merged with whatever comes next) being undone sooner or later
+	size_t attemptCount = 0;
+	size_t failureCount = 0;
+	size_t undoCount = 0;
+	size_t mostStableTokens = 0;
+	size_t stableTokensUndoneTo = 0;
+	while (ret.size() + (m_levels.empty() ? 0 : m_levels.back()->symbolCount()) < byteCount) {
+		if (++attemptCount > MAX_ATTEMPTS) {
+			throw GenerationException("No more input valid for '" + m_machine.name + "' could be generated after " + std::to_string(ret.size()) + " bytes -- the tokens keep running together");
+		}
+
+		const auto snapshots = snapshot();
+		bool generated;
+		if (m_parser != nullptr) {
+			auto rootIt = parserRoots.cbegin();
+			std::advance(rootIt, pickWeighted(rootWeights));
+			const TypeFormingStatement* root = rootIt->get();
+			if (height(root, &m_machine) == INFINITE_HEIGHT) {
+				throw GenerationException("The root '" + root->name + "' of '" + m_machine.name + "' can not be derived into any finite sentence");
+			}
+
+			m_sentence.clear();
+			expand(root, &m_machine, 0);
+			if (m_levels.empty()) {
+				for (SymbolIndex symbol : m_sentence) {
+					ret.push_back((char)(unsigned char)symbol);
+				}
+				attemptCount = 0;
+				continue;
+			}
+			generated = std::all_of(m_sentence.cbegin(), m_sentence.cend(), [this](SymbolIndex terminalTypeIndex) { return renderTerminal(0, terminalTypeIndex); });
+		} else {
+			generated = emitToken(0, pickWeighted(rootWeights));
+		}
+		generated = generated && std::all_of(m_levels.cbegin(), m_levels.cend(), [](const auto& level) { return level->unstableTokenCount() <= UNSTABLE_TOKENS; });
+
+		if (!generated) {
+			restore(snapshots);
+			if (++failureCount % RENDERING_ATTEMPTS == 0) {
+				// whatever the first token still open to being merged with what comes next allows after it has just been tried, so it is undone (along with everything after it),
+				// and so are more and more units before it should that not help either
+				const size_t unstableToken = m_levels.front()->snapshot().unstableToken;
+				size_t extraUndoDepth = undoCount == 0 ? 0 : std::min(UNDOABLE_UNITS, (size_t)1 << std::min<size_t>(undoCount, 16));
+				++undoCount;
+				bool isUnstableTokenUndone = false;
+				while (!undoableUnits.empty() && (!isUnstableTokenUndone || extraUndoDepth-- > 0)) {
+					restore(undoableUnits.back());
+					undoableUnits.pop_back();
+					isUnstableTokenUndone = m_levels.front()->snapshot().tokenCount <= unstableToken;
+				}
+				stableTokensUndoneTo = m_levels.front()->stableTokenCount();
+			}
+			continue;
+		}
+
+		// the undos get deeper until there is some progress past them, but only progress past anything before keeps the generation from giving up
+		failureCount = 0;
+		const size_t stableTokens = m_levels.front()->stableTokenCount();
+		if (stableTokens > stableTokensUndoneTo) {
+			stableTokensUndoneTo = stableTokens;
+			undoCount = 0;
+		}
+		if (stableTokens > mostStableTokens) {
+			mostStableTokens = stableTokens;
+			attemptCount = 0;
+		}
+		undoableUnits.push_back(snapshots);
+		if (undoableUnits.size() > UNDOABLE_UNITS) {
+			undoableUnits.pop_front();
+		}
+		takeStable();
+	}
+
+	// the input ends here, so nothing can be merged with the last tokens anymore
+	undoableUnits.clear();
+	for (auto& level : m_levels) {
+		level->finish();
+	}
+	takeStable();
+
+	return ret;
+}
+
+std::map<std::string, double> CorpusGenerator::parseWeights(const std::string& weights) {
+	std::map<std::string, double> ret;
+	size_t position = 0;
+	while (position < weights.size()) {
+		size_t end = weights.find(',', position);
+		if (end == std::string::npos) {
+			end = weights.size();
+		}
+		const std::string entry = weights.substr(position, end - position);
+		position = end + 1;
+
+		const size_t equalsPosition = entry.find('=');
+		if (equalsPosition == std::string::npos || equalsPosition == 0) {
+			throw GenerationException("The corpus weight '" + entry + "' is not of the form NAME=WEIGHT");
+		}
+
+		double weight;
+		try {
+			size_t parsedLength;
+			weight = std::stod(entry.substr(equalsPosition + 1), &parsedLength);
+			if (parsedLength != entry.size() - equalsPosition - 1) {
+				throw std::invalid_argument(entry);
+			}
+		} catch (const std::logic_error&) {
+			throw GenerationException("The corpus weight '" + entry + "' is not of the form NAME=WEIGHT");
+		}
+		if (weight < 0) {
+			throw GenerationException("The corpus weight '" + entry + "' is negative");
+		}
+		ret[entry.substr(0, equalsPosition)] = weight;
+	}
+
+	return ret;
+}
+
+size_t CorpusGenerator::pick(size_t count) {
+	return (size_t)(m_random() % count);
+}
+
+size_t CorpusGenerator::pickWeighted(const std::vector<double>& weights) {
+	double total = 0;
+	for (double weight : weights) {
+		total += weight;
+	}
+	// weighting everything 0 means no preference at all
+	if (total <= 0) {
+		return pick(weights.size());
+	}
+
+	double point = (double)(m_random() >> 11) / 9007199254740992.0 * total;
+	for (size_t index = 0; index < weights.size(); ++index) {
+		if (point < weights[index]) {
+			return index;
+		}
+		point -= weights[index];
+	}
+	// rounding
+	for (size_t index = weights.size(); index > 0; --index) {
+		if (weights[index - 1] > 0) {
+			return index - 1;
+		}
+	}
+	return 0;
+}
+
+double CorpusGenerator::weightOf(const std::string& name) const {
+	auto weightIt = m_weights.find(name);
+	return weightIt == m_weights.cend() ? 1.0 : weightIt->second;
+}
+
+bool CorpusGenerator::emitToken(size_t levelIndex, size_t rootIndex) {
+	AutomatonLevel& level = *m_levels[levelIndex];
+	const std::vector<SymbolIndex> lexeme = level.walk(rootIndex, m_random);
+	const auto snapshots = snapshot();
+	// the types of the tokens only matter if they are to be read by some machine above
+	if (!level.append(lexeme, rootIndex, levelIndex > 0 || m_parser != nullptr)) {
+		return false;
+	}
+
+	if (levelIndex + 1 < m_levels.size()) {
+		for (SymbolIndex terminalTypeIndex : lexeme) {
+			if (!renderTerminal(levelIndex + 1, terminalTypeIndex)) {
+				restore(snapshots);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool CorpusGenerator::renderTerminal(size_t levelIndex, SymbolIndex terminalTypeIndex) {
+	AutomatonLevel& level = *m_levels[levelIndex];
+	const size_t rootIndex = level.rootOfTerminal(terminalTypeIndex);
+	if (rootIndex == (size_t)-1) {
+		std::string terminalName = std::to_string(terminalTypeIndex);
+		for (const auto& production : level.machine().getTerminalProductions()) {
+			if (production->terminalTypeIndex == terminalTypeIndex) {
+				terminalName = production->name;
+			}
+		}
+		throw GenerationException("The terminal '" + terminalName + "' of '" + level.machine().name + "' is not a root of the machine and so can never be read from it");
+	}
+
+	for (size_t attempt = 0; attempt < RENDERING_ATTEMPTS; ++attempt) {
+		if (emitToken(levelIndex, rootIndex)) {
+			return true;
+		}
+	}
+
+	// the token may need something ignored to keep it apart from the one before
+	for (size_t ignoredRootIndex : level.ignoredRoots()) {
+		for (size_t attempt = 0; attempt < RENDERING_ATTEMPTS; ++attempt) {
+			const auto snapshots = snapshot();
+			if (emitToken(levelIndex, ignoredRootIndex) && emitToken(levelIndex, rootIndex)) {
+				return true;
+			}
+			restore(snapshots);
+		}
+	}
+
+	return false;
+}
+
+std::vector<CorpusGenerator::AutomatonLevel::Snapshot> CorpusGenerator::snapshot() const {
+	std::vector<AutomatonLevel::Snapshot> ret;
+	for (const auto& level : m_levels) {
+		ret.push_back(level->snapshot());
+	}
+	return ret;
+}
+
+void CorpusGenerator::restore(const std::vector<AutomatonLevel::Snapshot>& snapshots) {
+	for (size_t levelIndex = 0; levelIndex < m_levels.size(); ++levelIndex) {
+		m_levels[levelIndex]->restore(snapshots[levelIndex]);
+	}
+}
+
+const MachineDefinition* CorpusGenerator::terminalMachine() const {
+	// the parser may read the terminals of the machine it is on, or of one it `uses` (which is then applied to the input of the parser whenever a terminal is needed, just as if the parser were on it)
+	std::set<const MachineDefinition*> machines;
+	for (const auto& statementPair : m_machine.statements) {
+		if (auto category = dynamic_cast<const CategoryStatement*>(statementPair.second.get())) {
+			for (const auto& referencePair : category->references) {
+				const MachineDefinition* referenceMachine = nullptr;
+				if (referencePair.second.isAReferenceFromUnderlyingMachine && m_machine.findMachineStatement(referencePair.first, &referenceMachine) && referenceMachine != nullptr) {
+					machines.insert(referenceMachine);
+				}
+			}
+		} else if (auto rule = dynamic_cast<const RuleStatement*>(statementPair.second.get())) {
+			collectTerminalMachines(rule->regex.get(), machines);
+		}
+	}
+
+	// the terminals of an underlying machine the parser is not on get rendered by the machine all the way, so the parser must not read anything else
+	const MachineDefinition* ret = m_machine.on.second.get();
+	for (const MachineDefinition* referenceMachine : machines) {
+		if (referenceMachine != m_machine.on.second.get()) {
+			if (machines.size() > 1) {
+				throw GenerationException("Corpora can only be generated for parsers reading the terminals of a single machine, and '" + m_machine.name + "' reads those of '" + referenceMachine->name + "' along with others");
+			}
+			ret = referenceMachine;
+		}
+	}
+	return ret;
+}
+
+void CorpusGenerator::collectTerminalMachines(const Regex* regex, std::set<const MachineDefinition*>& machines) const {
+	if (auto disjunctive = dynamic_cast<const DisjunctiveRegex*>(regex)) {
+		for (const auto& conjunctive : disjunctive->disjunction) {
+			collectTerminalMachines(conjunctive.get(), machines);
+		}
+	} else if (auto conjunctive = dynamic_cast<const ConjunctiveRegex*>(regex)) {
+		for (const auto& rootRegex : conjunctive->conjunction) {
+			collectTerminalMachines(rootRegex.get(), machines);
+		}
+	} else if (auto repetitive = dynamic_cast<const RepetitiveRegex*>(regex)) {
+		collectTerminalMachines(repetitive->regex.get(), machines);
+	} else if (auto reference = dynamic_cast<const ReferenceRegex*>(regex)) {
+		if (reference->referenceStatementMachine != &m_machine) {
+			machines.insert(reference->referenceStatementMachine);
+		}
+	}
+}
+
+void CorpusGenerator::computeHeights() {
+	for (const auto& statementPair : m_machine.statements) {
+		m_heights[statementPair.second.get()] = INFINITE_HEIGHT;
+	}
+
+	// every statement is one level above the shallowest of its alternatives, which the heights converge to
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (const auto& statementPair : m_machine.statements) {
+			const MachineStatement* statement = statementPair.second.get();
+			size_t statementHeight = INFINITE_HEIGHT;
+			if (auto category = dynamic_cast<const CategoryStatement*>(statement)) {
+				for (const auto& referencePair : category->references) {
+					statementHeight = std::min(statementHeight, referencePair.second.isAReferenceFromUnderlyingMachine ? 0 : height(referencePair.second.statement, &m_machine));
+				}
+			} else if (auto rule = dynamic_cast<const RuleStatement*>(statement)) {
+				statementHeight = height(rule->regex.get());
+			}
+
+			if (statementHeight != INFINITE_HEIGHT && statementHeight + 1 < m_heights[statement]) {
+				m_heights[statement] = statementHeight + 1;
+				changed = true;
+			}
+		}
+	}
+}
+
+size_t CorpusGenerator::height(const Regex* regex) const {
+	if (auto disjunctive = dynamic_cast<const DisjunctiveRegex*>(regex)) {
+		size_t ret = INFINITE_HEIGHT;
+		for (const auto& conjunctive : disjunctive->disjunction) {
+			ret = std::min(ret, height(conjunctive.get()));
+		}
+		return ret;
+	} else if (auto conjunctive = dynamic_cast<const ConjunctiveRegex*>(regex)) {
+		size_t ret = 0;
+		for (const auto& rootRegex : conjunctive->conjunction) {
+			ret = std::max(ret, height(rootRegex.get()));
+		}
+		return ret;
+	} else if (auto repetitive = dynamic_cast<const RepetitiveRegex*>(regex)) {
+		return repetitive->minRepetitions == 0 ? 0 : height(repetitive->regex.get());
+	} else if (auto reference = dynamic_cast<const ReferenceRegex*>(regex)) {
+		return height(reference->referenceStatement, reference->referenceStatementMachine);
+	}
+
+	return 0;
+}
+
+size_t CorpusGenerator::height(const MachineStatement* statement, const MachineDefinition* statementMachine) const {
+	if (statementMachine != &m_machine) {
+		return 0;
+	}
+
+	auto heightIt = m_heights.find(statement);
+	return heightIt == m_heights.cend() ? INFINITE_HEIGHT : heightIt->second;
+}
+
+void CorpusGenerator::expand(const Regex* regex, size_t depth) {
+	// once deep or long enough, the sentence is finished as soon as possible
+	const bool shallowest = depth >= EXPANSION_DEPTH || m_sentence.size() >= SENTENCE_LENGTH;
+
+	if (auto disjunctive = dynamic_cast<const DisjunctiveRegex*>(regex)) {
+		std::vector<const ConjunctiveRegex*> alternatives;
+		std::vector<double> weights;
+		for (const auto& conjunctive : disjunctive->disjunction) {
+			alternatives.push_back(conjunctive.get());
+			const ReferenceRegex* loneReference = conjunctive->conjunction.size() == 1 ? dynamic_cast<const ReferenceRegex*>(conjunctive->conjunction.front().get()) : nullptr;
+			weights.push_back(loneReference != nullptr ? weightOf(loneReference->referenceName) : 1.0);
+		}
+
+		size_t chosen = 0;
+		if (shallowest) {
+			for (size_t alternativeIndex = 1; alternativeIndex < alternatives.size(); ++alternativeIndex) {
+				if (height(alternatives[alternativeIndex]) < height(alternatives[chosen])) {
+					chosen = alternativeIndex;
+				}
+			}
+		} else {
+			chosen = pickWeighted(weights);
+		}
+		expand(alternatives[chosen], depth);
+	} else if (auto conjunctive = dynamic_cast<const ConjunctiveRegex*>(regex)) {
+		for (const auto& rootRegex : conjunctive->conjunction) {
+			expand(rootRegex.get(), depth);
+		}
+	} else if (auto repetitive = dynamic_cast<const RepetitiveRegex*>(regex)) {
+		unsigned long repetitionCount = repetitive->minRepetitions;
+		if (!shallowest) {
+			while ((repetitive->maxRepetitions == RepetitiveRegex::INFINITE_REPETITIONS || repetitionCount < repetitive->maxRepetitions) && pick(2) == 0) {
+				++repetitionCount;
+			}
+		}
+		for (unsigned long repetition = 0; repetition < repetitionCount; ++repetition) {
+			expand(repetitive->regex.get(), depth);
+		}
+	} else if (auto reference = dynamic_cast<const ReferenceRegex*>(regex)) {
+		expand(reference->referenceStatement, reference->referenceStatementMachine, depth + 1);
+	} else if (auto literal = dynamic_cast<const LiteralRegex*>(regex)) {
+		if (!m_levels.empty()) {
+			throw GenerationException("The parser '" + m_machine.name + "' is on terminal input, yet it reads the literal at " + literal->locationString());
+		}
+		for (char character : literal->literal) {
+			m_sentence.push_back((unsigned char)character);
+		}
+	} else if (auto any = dynamic_cast<const AnyRegex*>(regex)) {
+		if (!m_levels.empty()) {
+			throw GenerationException("The parser '" + m_machine.name + "' is on terminal input, yet it reads the byte class at " + any->locationString());
+		}
+		std::vector<bool> isMember(256, false);
+		for (const auto& symbolGroup : any->makeSymbolGroups()) {
+			for (SymbolIndex symbolIndex : *symbolGroup->retrieveSymbolIndices()) {
+				isMember[symbolIndex] = true;
+			}
+		}
+
+		const bool excepting = dynamic_cast<const ExceptAnyRegex*>(regex) != nullptr;
+		std::vector<SymbolIndex> candidates;
+		for (SymbolIndex symbolIndex = 0; symbolIndex < isMember.size(); ++symbolIndex) {
+			if (isMember[symbolIndex] != excepting) {
+				candidates.push_back(symbolIndex);
+			}
+		}
+		if (!candidates.empty()) {
+			m_sentence.push_back(candidates[pick(candidates.size())]);
+		}
+	} else if (dynamic_cast<const ArbitrarySymbolRegex*>(regex)) {
+		emitArbitrarySymbol();
+	}
+}
+
+void CorpusGenerator::expand(const MachineStatement* statement, const MachineDefinition* statementMachine, size_t depth) {
+	if (statementMachine != &m_machine) {
+		emitTerminal(statement);
+		return;
+	}
+
+	if (auto category = dynamic_cast<const CategoryStatement*>(statement)) {
+		std::vector<const CategoryReference*> members;
+		std::vector<double> weights;
+		for (const auto& referencePair : category->references) {
+			members.push_back(&referencePair.second);
+			weights.push_back(weightOf(referencePair.first));
+		}
+		if (members.empty()) {
+			throw GenerationException("The category '" + category->name + "' of '" + m_machine.name + "' has no members to generate");
+		}
+
+		size_t chosen = 0;
+		if (depth >= EXPANSION_DEPTH || m_sentence.size() >= SENTENCE_LENGTH) {
+			auto memberHeight = [this](const CategoryReference* member) { return member->isAReferenceFromUnderlyingMachine ? 0 : height(member->statement, &m_machine); };
+			for (size_t memberIndex = 1; memberIndex < members.size(); ++memberIndex) {
+				if (memberHeight(members[memberIndex]) < memberHeight(members[chosen])) {
+					chosen = memberIndex;
+				}
+			}
+		} else {
+			chosen = pickWeighted(weights);
+		}
+
+		if (members[chosen]->isAReferenceFromUnderlyingMachine) {
+			emitTerminal(members[chosen]->statement);
+		} else {
+			expand(members[chosen]->statement, &m_machine, depth + 1);
+		}
+	} else if (auto rule = dynamic_cast<const RuleStatement*>(statement)) {
+		expand(rule->regex.get(), depth);
+	}
+}
+
+void CorpusGenerator::emitTerminal(const MachineStatement* statement) {
+	if (auto production = dynamic_cast<const ProductionStatement*>(statement)) {
+		m_sentence.push_back(production->terminalTypeIndex);
+		return;
+	}
+
+	// a category of the underlying machine stands for any of its productions
+	auto attributedStatement = dynamic_cast<const AttributedStatement*>(statement);
+	if (attributedStatement == nullptr) {
+		throw GenerationException("The parser '" + m_machine.name + "' reads '" + statement->name + "', which is not a terminal of the machine it is on");
+	}
+	std::vector<const ProductionStatement*> productions;
+	std::vector<double> weights;
+	for (const ProductionStatement* production : attributedStatement->calculateInstandingProductions()) {
+		productions.push_back(production);
+		weights.push_back(weightOf(production->name));
+	}
+	if (productions.empty()) {
+		throw GenerationException("The parser '" + m_machine.name + "' reads '" + statement->name + "', which stands for no terminal of the machine it is on");
+	}
+	m_sentence.push_back(productions[pickWeighted(weights)]->terminalTypeIndex);
+}
+
+void CorpusGenerator::emitArbitrarySymbol() {
+	if (m_levels.empty()) {
+		m_sentence.push_back(pick(256));
+		return;
+	}
+
+	const auto terminalRoots = m_levels.front()->machine().getTerminalRoots();
+	if (terminalRoots.empty()) {
+		throw GenerationException("The parser '" + m_machine.name + "' reads an arbitrary terminal, but the machine it is on has no terminal roots");
+	}
+	auto rootIt = terminalRoots.cbegin();
+	std::advance(rootIt, pick(terminalRoots.size()));
+	m_sentence.push_back((*rootIt)->terminalTypeIndex);
+}
+
+CorpusGenerator::AutomatonLevel::AutomatonLevel(const FiniteAutomatonDefinition& machine, const std::map<std::string, double>& weights)
+	: m_machine(machine), m_symbolCount(machine.on.second ? machine.on.second->terminalProductionCount() + 1 : 256), m_unstableToken(0), m_takenTokenCount(0) {
+	NFABuilder builder(machine, nullptr, "m_token");
+	for (const auto& typeFormingStatement : machine.getTypeFormingStatements()) {
+		if (typeFormingStatement->rootness == Rootness::Unspecified) {
+			continue;
+		}
+
+		if (typeFormingStatement->rootness == Rootness::IgnoreRoot) {
+			m_ignoredRoots.push_back(m_roots.size());
+		}
+		auto weightIt = weights.find(typeFormingStatement->name);
+		m_rootWeights.push_back(weightIt == weights.cend() ? 1.0 : weightIt->second);
+		m_roots.push_back(typeFormingStatement.get());
+
+		// every root gets a pseudo-DFA of its own, so that the tokens can be told apart when tokenizing again
+		NFA rootNfa = std::dynamic_pointer_cast<INFABuildable>(typeFormingStatement)->accept(builder);
+		m_automata.push_back(prepareAutomaton(rootNfa.buildPseudoDFA()));
+	}
+
+	for (const HashedKeyword& hashedKeyword : machine.getHashedKeywords()) {
+		auto keywordIt = std::find(m_roots.cbegin(), m_roots.cend(), hashedKeyword.keyword.get());
+		auto identifierIt = std::find(m_roots.cbegin(), m_roots.cend(), hashedKeyword.identifier.get());
+		if (keywordIt != m_roots.cend() && identifierIt != m_roots.cend()) {
+			m_hashedKeywordRoots.emplace_back(keywordIt - m_roots.cbegin(), identifierIt - m_roots.cbegin());
+		}
+	}
+}
+
+size_t CorpusGenerator::AutomatonLevel::rootOfTerminal(SymbolIndex terminalTypeIndex) const {
+	for (size_t rootIndex = 0; rootIndex < m_roots.size(); ++rootIndex) {
+		auto production = dynamic_cast<const ProductionStatement*>(m_roots[rootIndex]);
+		if (production != nullptr && m_roots[rootIndex]->rootness == Rootness::AcceptRoot && production->terminalTypeIndex == terminalTypeIndex) {
+			return rootIndex;
+		}
+	}
+
+	return (size_t)-1;
+}
+
+std::vector<SymbolIndex> CorpusGenerator::AutomatonLevel::walk(size_t rootIndex, std::mt19937_64& random) const {
+	const Automaton& automaton = m_automata[rootIndex];
+	std::vector<SymbolIndex> ret;
+	State state = 0;
+	while (true) {
+		const auto& edges = automaton.edges[state];
+		if (automaton.final[state] && !ret.empty() && (edges.empty() || ret.size() >= WALK_LENGTH || random() % 3 == 0)) {
+			break;
+		}
+
+		// never into a state no final state is reachable from, and only closer to one once the lexeme is long enough
+		std::vector<size_t> candidates;
+		for (size_t edgeIndex = 0; edgeIndex < edges.size(); ++edgeIndex) {
+			const size_t targetDistance = automaton.distanceToFinal[edges[edgeIndex].first];
+			if (targetDistance == UNREACHABLE || (ret.size() >= WALK_LENGTH && targetDistance >= automaton.distanceToFinal[state])) {
+				continue;
+			}
+			candidates.push_back(edgeIndex);
+		}
+		if (candidates.empty()) {
+			break;
+		}
+
+		const auto& edge = edges[candidates[random() % candidates.size()]];
+		ret.push_back(edge.second[random() % edge.second.size()]);
+		state = edge.first;
+	}
+
+	if (!automaton.final[state]) {
+		ret.clear();
+	}
+	return ret;
+}
+
+bool CorpusGenerator::AutomatonLevel::append(const std::vector<SymbolIndex>& lexeme, size_t rootIndex, bool typesMatter) {
+	if (lexeme.empty()) {
+		return false;
+	}
+
+	const Snapshot before = snapshot();
+	m_tokens.push_back({ m_symbols.size(), m_symbols.size() + lexeme.size(), rootIndex });
+	m_symbols.insert(m_symbols.end(), lexeme.cbegin(), lexeme.cend());
+
+	// the unstable tokens are tokenized again, by the longest match of all the roots, and have to come out just as they have been appended
+	size_t position = m_tokens[m_unstableToken].begin;
+	size_t unstableToken = m_tokens.size();
+	std::vector<std::vector<State>> currentStates(m_roots.size());
+	std::vector<State> nextStates;
+	std::vector<size_t> matchedRoots;
+	for (size_t tokenIndex = m_unstableToken; tokenIndex < m_tokens.size(); ++tokenIndex) {
+		for (auto& states : currentStates) {
+			states.assign(1, 0);
+		}
+		size_t matchLength = 0;
+		matchedRoots.clear();
+
+		bool alive = true;
+		size_t length = 0;
+		while (alive && position + length < m_symbols.size()) {
+			const SymbolIndex symbol = m_symbols[position + length];
+			++length;
+			alive = false;
+			for (size_t candidateRoot = 0; candidateRoot < m_roots.size(); ++candidateRoot) {
+				const Automaton& automaton = m_automata[candidateRoot];
+				nextStates.clear();
+				bool final = false;
+				if (symbol < m_symbolCount) {
+					for (State state : currentStates[candidateRoot]) {
+						for (State target : automaton.targets[state * m_symbolCount + symbol]) {
+							if (std::find(nextStates.cbegin(), nextStates.cend(), target) == nextStates.cend()) {
+								nextStates.push_back(target);
+								final = final || automaton.final[target];
+							}
+						}
+					}
+				}
+				currentStates[candidateRoot].swap(nextStates);
+
+				if (final) {
+					if (length > matchLength) {
+						matchLength = length;
+						matchedRoots.clear();
+					}
+					matchedRoots.push_back(candidateRoot);
+				}
+				alive = alive || !currentStates[candidateRoot].empty();
+			}
+		}
+
+		// anything still running at the very end might yet be extended by whatever gets appended
+		if (alive && unstableToken == m_tokens.size()) {
+			unstableToken = tokenIndex;
+		}
+
+		const Token& token = m_tokens[tokenIndex];
+		if (matchLength == 0 || position + matchLength != token.end || (typesMatter && resolveTie(matchedRoots) != token.rootIndex)) {
+			restore(before);
+			return false;
+		}
+		position += matchLength;
+	}
+
+	m_unstableToken = unstableToken;
+	return true;
+}
+
+void CorpusGenerator::AutomatonLevel::restore(const Snapshot& snapshot) {
+	m_symbols.resize(snapshot.symbolCount);
+	m_tokens.resize(snapshot.tokenCount);
+	m_unstableToken = snapshot.unstableToken;
+}
+
+CorpusGenerator::AutomatonLevel::Snapshot CorpusGenerator::AutomatonLevel::takeStable(std::vector<SymbolIndex>& stableSymbols, size_t tokenLimit) {
+	const size_t stableTokenCount = std::min(m_unstableToken, tokenLimit);
+	const size_t stableSymbolCount = stableTokenCount < m_tokens.size() ? m_tokens[stableTokenCount].begin : m_symbols.size();
+	stableSymbols.insert(stableSymbols.end(), m_symbols.cbegin(), m_symbols.cbegin() + stableSymbolCount);
+	m_symbols.erase(m_symbols.begin(), m_symbols.begin() + stableSymbolCount);
+	m_tokens.erase(m_tokens.begin(), m_tokens.begin() + stableTokenCount);
+	for (Token& token : m_tokens) {
+		token.begin -= stableSymbolCount;
+		token.end -= stableSymbolCount;
+	}
+	m_unstableToken -= stableTokenCount;
+	m_takenTokenCount += stableTokenCount;
+
+	return { stableSymbolCount, stableTokenCount, 0 };
+}
+
+CorpusGenerator::AutomatonLevel::Automaton CorpusGenerator::AutomatonLevel::prepareAutomaton(const NFA& pseudoDFA) const {
+	Automaton ret;
+	const size_t stateCount = pseudoDFA.states.size();
+	ret.targets.resize(stateCount * m_symbolCount);
+	ret.edges.resize(stateCount);
+	ret.final.resize(stateCount);
+	ret.distanceToFinal.assign(stateCount, UNREACHABLE);
+
+	std::vector<std::vector<State>> sources(stateCount);
+	for (State state = 0; state < stateCount; ++state) {
+		ret.final[state] = pseudoDFA.finalStates.count(state) > 0;
+		for (const auto& transition : pseudoDFA.states[state].transitions) {
+			if (dynamic_cast<const EmptySymbolGroup*>(transition.condition.get()) != nullptr) {
+				continue;
+			}
+
+			std::vector<SymbolIndex> symbols;
+			for (SymbolIndex symbolIndex : *transition.condition->retrieveSymbolIndices()) {
+				if (symbolIndex < m_symbolCount) {
+					ret.targets[state * m_symbolCount + symbolIndex].push_back(transition.target);
+					symbols.push_back(symbolIndex);
+				}
+			}
+			if (!symbols.empty()) {
+				ret.edges[state].emplace_back(transition.target, std::move(symbols));
+				sources[transition.target].push_back(state);
+			}
+		}
+	}
+
+	// breadth-first from the final states, backwards
+	std::deque<State> queue;
+	for (State state = 0; state < stateCount; ++state) {
+		if (ret.final[state]) {
+			ret.distanceToFinal[state] = 0;
+			queue.push_back(state);
+		}
+	}
+	while (!queue.empty()) {
+		const State state = queue.front();
+		queue.pop_front();
+		for (State source : sources[state]) {
+			if (ret.distanceToFinal[source] == UNREACHABLE) {
+				ret.distanceToFinal[source] = ret.distanceToFinal[state] + 1;
+				queue.push_back(source);
+			}
+		}
+	}
+
+	return ret;
+}
+
+size_t CorpusGenerator::AutomatonLevel::resolveTie(const std::vector<size_t>& rootIndices) const {
+	if (rootIndices.size() == 1) {
+		return rootIndices.front();
+	}
+
+	// a hashed keyword is matched as its identifier and told apart only afterwards, so it always wins over it
+	std::vector<size_t> remaining;
+	for (size_t rootIndex : rootIndices) {
+		const bool isOutdone = std::any_of(m_hashedKeywordRoots.cbegin(), m_hashedKeywordRoots.cend(), [&rootIndices, rootIndex](const std::pair<size_t, size_t>& keywordIdentifierPair) {
+			return keywordIdentifierPair.second == rootIndex && std::find(rootIndices.cbegin(), rootIndices.cend(), keywordIdentifierPair.first) != rootIndices.cend();
+		});
+		if (!isOutdone) {
+			remaining.push_back(rootIndex);
+		}
+	}
+
+	// otherwise it is not up to the generator to guess how the ambiguity gets resolved
+	return remaining.size() == 1 ? remaining.front() : AMBIGUOUS;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "NFA.h"
+#include "MachineDefinition.h"
+#include "FiniteAutomatonDefinition.h"
+#include "LLkParserDefinition.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+	Generates random inputs valid for a machine, e.g. to benchmark the generated code on as much realistic input as needed without having to ship it.
+	Finite automata are walked through the pseudo-DFAs of their roots, every token walked being appended only if the input still tokenizes back into exactly the tokens walked (longest match taken into account), and the last ones undone should nothing fit after them;
+	a finite automaton on another one has every token it walks rendered in the tokens of the underlying one, with ignored tokens put in between wherever the tokens would run together otherwise.
+	LL parsers have their roots expanded through the productions their decision trees are built from, choosing the alternatives and repetitions at random (and the shortest ones once the sentence gets deep or long),
+	and the terminals the sentences are made of are rendered by the underlying finite automata in the same way (those of a machine the parser `uses` rather than is on, by that machine and the ones it is on).
+	The generation only depends on the seed and the weights (the relative probabilities of the roots, category members and alternatives referring to a single statement, 1 by default), so a corpus can always be made again.
+*/
+class CorpusGenerator {
+public:
+	CorpusGenerator(const MachineDefinition& machine, uint64_t seed, const std::map<std::string, double>& weights);
+
+	std::string generate(size_t byteCount);
+
+	static std::map<std::string, double> parseWeights(const std::string& weights); // "NAME=WEIGHT,NAME=WEIGHT,..."
+
+private:
+	/*
+		The tokens of one finite automaton appended so far, along with the symbols (bytes or the terminal types of the underlying machine) they are made of.
+		The tokens before the unstable one can no longer be affected by anything appended, so only the rest of them is tokenized again on every append.
+	*/
+	class AutomatonLevel {
+	public:
+		struct Snapshot {
+			size_t symbolCount;
+			size_t tokenCount;
+			size_t unstableToken;
+		};
+
+		AutomatonLevel(const FiniteAutomatonDefinition& machine, const std::map<std::string, double>& weights);
+
+		const FiniteAutomatonDefinition& machine() const { return m_machine; }
+		size_t rootCount() const { return m_roots.size(); }
+		size_t symbolCount() const { return m_symbols.size(); }
+		size_t unstableTokenCount() const { return m_tokens.size() - m_unstableToken; }
+		size_t stableTokenCount() const { return m_takenTokenCount + m_unstableToken; } // the taken ones included
+		double rootWeight(size_t rootIndex) const { return m_rootWeights[rootIndex]; }
+		const std::vector<size_t>& ignoredRoots() const { return m_ignoredRoots; }
+		size_t rootOfTerminal(SymbolIndex terminalTypeIndex) const; // SIZE_MAX if no root produces the terminal
+
+		std::vector<SymbolIndex> walk(size_t rootIndex, std::mt19937_64& random) const;
+		bool append(const std::vector<SymbolIndex>& lexeme, size_t rootIndex, bool typesMatter);
+
+		Snapshot snapshot() const { return { m_symbols.size(), m_tokens.size(), m_unstableToken }; }
+		void restore(const Snapshot& snapshot);
+		Snapshot takeStable(std::vector<SymbolIndex>& stableSymbols, size_t tokenLimit); // moves the symbols of (at most tokenLimit) tokens that can no longer change to stableSymbols, returning how much has been taken
+		void finish() { m_unstableToken = m_tokens.size(); } // all the tokens become stable once nothing is going to be appended
+
+	private:
+		static constexpr size_t AMBIGUOUS = (size_t)-1;
+		static constexpr size_t UNREACHABLE = (size_t)-1;
+		static constexpr size_t WALK_LENGTH = 24; // after so many symbols the walk heads for the closest final state
+
+		struct Automaton {
+			std::vector<std::vector<State>> targets; // by state * symbolCount + symbol
+			std::vector<std::vector<std::pair<State, std::vector<SymbolIndex>>>> edges; // by state, the symbols leading to every target
+			std::vector<bool> final;
+			std::vector<size_t> distanceToFinal;
+		};
+
+		struct Token {
+			size_t begin;
+			size_t end;
+			size_t rootIndex;
+		};
+
+		const FiniteAutomatonDefinition& m_machine;
+		size_t m_symbolCount;
+		std::vector<const TypeFormingStatement*> m_roots; // the accepted and ignored ones
+		std::vector<double> m_rootWeights;
+		std::vector<size_t> m_ignoredRoots;
+		std::vector<std::pair<size_t, size_t>> m_hashedKeywordRoots; // the hashed keyword and its identifier
+		std::vector<Automaton> m_automata;
+
+		std::vector<SymbolIndex> m_symbols;
+		std::vector<Token> m_tokens;
+		size_t m_unstableToken;
+		size_t m_takenTokenCount;
+
+		Automaton prepareAutomaton(const NFA& pseudoDFA) const;
+		size_t resolveTie(const std::vector<size_t>& rootIndices) const;
+	};
+
+	const MachineDefinition& m_machine;
+	const LLkParserDefinition* m_parser;
+	std::map<std::string, double> m_weights;
+	std::mt19937_64 m_random;
+	std::vector<std::unique_ptr<AutomatonLevel>> m_levels; // the finite automaton generated for (or the one the terminals of the parser come from) first, then the one it is on, and so on down to raw input
+
+	static constexpr size_t EXPANSION_DEPTH = 12;
+	static constexpr size_t SENTENCE_LENGTH = 4096;
+	static constexpr size_t MAX_ATTEMPTS = 100000; // without any more tokens becoming stable
+	static constexpr size_t RENDERING_ATTEMPTS = 8; // before the last unit is undone, and twice as many of them after every so many undos that got nowhere
+	static constexpr size_t UNSTABLE_TOKENS = 16; // more of them and the tokenization gets too slow to check, the input too slow to tokenize
+	static constexpr size_t UNDOABLE_UNITS = 64;
+	static constexpr size_t INFINITE_HEIGHT = (size_t)-1;
+	std::map<const MachineStatement*, size_t> m_heights; // how deep the shallowest derivation of every statement of the parser goes
+
+	std::vector<SymbolIndex> m_sentence;
+
+	size_t pick(size_t count); // platform-independent, unlike the distributions of the standard library
+	size_t pickWeighted(const std::vector<double>& weights);
+	double weightOf(const std::string& name) const;
+
+	bool emitToken(size_t levelIndex, size_t rootIndex);
+	bool renderTerminal(size_t levelIndex, SymbolIndex terminalTypeIndex);
+	std::vector<AutomatonLevel::Snapshot> snapshot() const;
+	void restore(const std::vector<AutomatonLevel::Snapshot>& snapshots);
+
+	const MachineDefinition* terminalMachine() const; // the machine whose terminals the sentences of the parser are made of (null if raw input)
+	void collectTerminalMachines(const Regex* regex, std::set<const MachineDefinition*>& machines) const;
+
+	void computeHeights();
+	size_t height(const Regex* regex) const;
+	size_t height(const MachineStatement* statement, const MachineDefinition* statementMachine) const;
+	void expand(const Regex* regex, size_t depth);
+	void expand(const MachineStatement* statement, const MachineDefinition* statementMachine, size_t depth);
+	void emitTerminal(const MachineStatement* statement);
+	void emitArbitrarySymbol();
+};
@@ -8,6 +8,8 @@
 #include "CppNFAGenerationHelper.h"
 #include "CppLLkParserGenerator.h"
 #include "GenerationException.h"
+#include "MachineScheduler.h"
+#include "GeneratorTrace.h"
 
 void CppGenerationVisitor::setup() const {
 	if (std::filesystem::exists(m_folderPath)) {
@@ -18,20 +20,137 @@ void CppGenerationVisitor::setup() const {
 		std::filesystem::create_directory(m_folderPath);
 	}
 	
-	std::filesystem::copy_file("Resources/Exception.h", m_folderPath / "Exception.h", std::filesystem::copy_options::overwrite_existing);
-	std::filesystem::copy_file("Resources/Location.h", m_folderPath / "Location.h", std::filesystem::copy_options::overwrite_existing);
-	std::filesystem::copy_file("Resources/Location.cpp", m_folderPath / "Location.cpp", std::filesystem::copy_options::overwrite_existing);
-	std::filesystem::copy_file("Resources/Production.h", m_folderPath / "Production.h", std::filesystem::copy_options::overwrite_existing);
-	std::filesystem::copy_file("Resources/Terminal.h", m_folderPath / "Terminal.h", std::filesystem::copy_options::overwrite_existing);
-	std::filesystem::copy_file("Resources/ProductionStream.h", m_folderPath / "ProductionStream.h", std::filesystem::copy_options::overwrite_existing);
-	std::filesystem::copy_file("Resources/Machine.h", m_folderPath / "Machine.h", std::filesystem::copy_options::overwrite_existing);
-	std::filesystem::copy_file("Resources/Parser.h", m_folderPath / "Parser.h", std::filesystem::copy_options::overwrite_existing);
+	GenerationHelper::copyFileIfChanged("Resources/Exception.h", m_folderPath / "Exception.h");
+	GenerationHelper::copyFileIfChanged("Resources/Location.h", m_folderPath / "Location.h");
+	GenerationHelper::copyFileIfChanged("Resources/Location.cpp", m_folderPath / "Location.cpp");
+	GenerationHelper::copyFileIfChanged("Resources/Production.h", m_folderPath / "Production.h");
+	GenerationHelper::copyFileIfChanged("Resources/AllocationAccounting.h", m_folderPath / "AllocationAccounting.h");
+	GenerationHelper::copyFileIfChanged("Resources/Terminal.h", m_folderPath / "Terminal.h");
+	GenerationHelper::copyFileIfChanged("Resources/ProductionStream.h", m_folderPath / "ProductionStream.h");
+	GenerationHelper::copyFileIfChanged("Resources/Instrumentation.h", m_folderPath / "Instrumentation.h");
+	GenerationHelper::copyFileIfChanged("Resources/TraceEvents.h", m_folderPath / "TraceEvents.h");
+	GenerationHelper::copyFileIfChanged("Resources/Machine.h", m_folderPath / "Machine.h");
+	GenerationHelper::copyFileIfChanged("Resources/Parser.h", m_folderPath / "Parser.h");
+	GenerationHelper::copyFileIfChanged("Resources/ParallelParser.h", m_folderPath / "ParallelParser.h");
+	if (m_emitsInterpretableTables) {
+		GenerationHelper::copyFileIfChanged("Resources/InterpretedAutomaton.h", m_folderPath / "InterpretedAutomaton.h");
+		GenerationHelper::copyFileIfChanged("Resources/InterpretedAutomaton.cpp", m_folderPath / "InterpretedAutomaton.cpp");
+	}
+	if (m_profilesParsers) {
+		GenerationHelper::copyFileIfChanged("Resources/ParserProfiler.h", m_folderPath / "ParserProfiler.h");
+	}
 }
 
 void CppGenerationVisitor::visit(const SyntacticTree* tree) {
-	for (const auto machineDefinitionPair : tree->machineDefinitions) {
-		machineDefinitionPair.second->accept(this);
+	// the raw stream files are shared by all the machines on raw input, so copy them here rather than have the machines race for them
+	for (const auto& machineDefinitionPair : tree->machineDefinitions) {
+		if (!machineDefinitionPair.second->on.second) {
+			includeRawStreamFiles();
+			break;
+		}
 	}
+
+	// every machine is generated by a visitor of its own, the outputs being separate files, the order in which they are written does not matter
+	MachineScheduler scheduler(tree->machineDefinitions, tree->jobCount);
+	scheduler.run([this, tree](const std::shared_ptr<MachineDefinition>& machine) {
+		if (machine->isUpToDate()) {
+			return;
+		}
+
+		GeneratorTrace::Span emissionSpan(tree->trace, "emit " + machine->name, "emission");
+		CppGenerationVisitor machineVisitor(m_folderPath.string(), m_emitsInterpretableTables, m_profilesParsers);
+		machineVisitor.m_hasIncludedRawStreamFiles = m_hasIncludedRawStreamFiles;
+		machine->accept(&machineVisitor);
+	});
+
+	writeManifest(tree);
+}
+
+void CppGenerationVisitor::markUpToDateMachines(const SyntacticTree* tree) const {
+	std::ifstream manifestFile(m_folderPath / MANIFEST_FILE_NAME);
+	if (!manifestFile) {
+		return;
+	}
+
+	std::string line, word;
+	Fingerprint recordedFingerprint;
+	std::getline(manifestFile, line);
+	std::stringstream headerLine(line);
+	if (!(headerLine >> word) || word != "astir" || !(headerLine >> word) || !FingerprintBuilder::fromString(word, recordedFingerprint) || recordedFingerprint != computeGeneratorFingerprint()) {
+		// written by some other version of the generator, everything needs to be regenerated
+		return;
+	}
+
+	while (std::getline(manifestFile, line)) {
+		std::stringstream machineLine(line);
+		std::string machineName, machineFingerprintString, headerFingerprintString, codeFingerprintString, backtrackingString;
+		if (!(machineLine >> machineName >> machineFingerprintString >> headerFingerprintString >> codeFingerprintString)) {
+			continue;
+		}
+		machineLine >> backtrackingString;
+
+		auto machineIt = tree->machineDefinitions.find(machineName);
+		if (machineIt == tree->machineDefinitions.end()) {
+			continue;
+		}
+
+		Fingerprint recordedMachineFingerprint, recordedHeaderFingerprint, recordedCodeFingerprint;
+		if (!FingerprintBuilder::fromString(machineFingerprintString, recordedMachineFingerprint)
+			|| !FingerprintBuilder::fromString(headerFingerprintString, recordedHeaderFingerprint)
+			|| !FingerprintBuilder::fromString(codeFingerprintString, recordedCodeFingerprint)) {
+			continue;
+		}
+
+		// finite automata are not analyzed again either, so the backtracking analysis of the last build has to be there
+		auto finiteAutomatonDefinition = std::dynamic_pointer_cast<FiniteAutomatonDefinition>(machineIt->second);
+		BacktrackingAnalysis recordedBacktracking;
+		if (finiteAutomatonDefinition && !BacktrackingAnalysis::fromString(backtrackingString, recordedBacktracking)) {
+			continue;
+		}
+
+		// the outputs must be there and untouched as well, for they will not be rewritten
+		const auto headerPath = m_folderPath / (machineName + ".h");
+		const auto codePath = m_folderPath / (machineName + ".cpp");
+		if (recordedMachineFingerprint == tree->machineFingerprint(machineName)
+			&& std::filesystem::exists(headerPath) && FingerprintBuilder::of(GenerationHelper::readFile(headerPath)) == recordedHeaderFingerprint
+			&& std::filesystem::exists(codePath) && FingerprintBuilder::of(GenerationHelper::readFile(codePath)) == recordedCodeFingerprint) {
+			if (finiteAutomatonDefinition) {
+				finiteAutomatonDefinition->restoreBacktracking(recordedBacktracking);
+			}
+			machineIt->second->markUpToDate();
+		}
+	}
+}
+
+void CppGenerationVisitor::writeManifest(const SyntacticTree* tree) const {
+	std::stringstream manifest;
+	manifest << "astir " << FingerprintBuilder::toString(computeGeneratorFingerprint()) << std::endl;
+	for (const auto& machineDefinitionPair : tree->machineDefinitions) {
+		const std::string& machineName = machineDefinitionPair.first;
+		manifest << machineName
+			<< ' ' << FingerprintBuilder::toString(tree->machineFingerprint(machineName))
+			<< ' ' << FingerprintBuilder::toString(FingerprintBuilder::of(GenerationHelper::readFile(m_folderPath / (machineName + ".h"))))
+			<< ' ' << FingerprintBuilder::toString(FingerprintBuilder::of(GenerationHelper::readFile(m_folderPath / (machineName + ".cpp"))));
+		if (auto finiteAutomatonDefinition = std::dynamic_pointer_cast<FiniteAutomatonDefinition>(machineDefinitionPair.second)) {
+			manifest << ' ' << finiteAutomatonDefinition->backtracking().toString();
+		}
+		manifest << std::endl;
+	}
+
+	GenerationHelper::writeFileIfChanged(m_folderPath / MANIFEST_FILE_NAME, manifest.str());
+}
+
+Fingerprint CppGenerationVisitor::computeGeneratorFingerprint() const {
+	// the generated code is determined by the generator and its specimens as much as it is by the grammar
+	FingerprintBuilder builder;
+	builder << std::string(MANIFEST_FORMAT_VERSION);
+	builder << std::string(EMISSION_REVISION);
+	builder << std::string(m_emitsInterpretableTables ? "interpretable" : "");
+	builder << std::string(m_profilesParsers ? "profiling" : "");
+	for (const char* specimenPath : { "Resources/SpecimenFiniteAutomaton.sh", "Resources/SpecimenFiniteAutomaton.scpp", "Resources/SpecimenLLkParser.sh", "Resources/SpecimenLLkParser.scpp" }) {
+		builder << GenerationHelper::readFile(specimenPath, true);
+	}
+	return builder.value();
 }
 
 void CppGenerationVisitor::visit(const FiniteAutomatonDefinition* machine) {
@@ -57,35 +176,69 @@ void CppGenerationVisitor::visit(const FiniteAutomatonDefinition* machine) {
 	}
 	macros.emplace("TransitionSymbolCount", std::to_string(numberOfInputTerminals));
 
-	CppNFAGenerationHelper cngh(machine->name, nfa, numberOfInputTerminals);
+	CppNFAGenerationHelper cngh(machine->name, nfa, numberOfInputTerminals, machine->getHashedKeywords());
 	//  - generate action context declarations
 	macros.emplace("ActionContextsDeclarations", cngh.generateContextDeclarations());
 
 	// generate this bulk by traversing the NFA only once
 	std::string stateMap;
-	std::string actionRegisterDeclarations;
-	std::string actionRegisterDefinitions;
+	std::string actionRegisterTypeName;
+	std::string actionRegisterCases;
 	std::string transitionActionMap;
 	std::string stateActionMap;
-	cngh.generateMechanicsMaps(stateMap, actionRegisterDeclarations, actionRegisterDefinitions, transitionActionMap, stateActionMap);
+	cngh.generateMechanicsMaps(stateMap, actionRegisterTypeName, actionRegisterCases, transitionActionMap, stateActionMap);
 
 	//  - generate state map
 	macros.emplace("StateMapEnumerated", stateMap);
 
-	//  - generate action decs&defs&maps
-	macros.emplace("ActionDeclarations", actionRegisterDeclarations);
-	macros.emplace("ActionDefinitions", actionRegisterDefinitions);
+	//  - generate action register switch&maps
+	macros.emplace("ActionRegisterTypeName", actionRegisterTypeName);
+	macros.emplace("ActionRegisterCases", actionRegisterCases);
 	macros.emplace("TransitionActionMapEnumerated", transitionActionMap);
 	macros.emplace("StateActionMapEnumerated", stateActionMap);
 
 	//  - generate state finality
 	macros.emplace("StateFinalityEnumerated", cngh.generateStateFinality());
 
-	std::ofstream faHeader(m_folderPath / (machine->name + ".h"));
-	std::ofstream faCode(m_folderPath / (machine->name + ".cpp"));
+	//  - generate the skipping of ignored runs, the raw streams being the only ones that can skip bytes
+	macros.emplace("IgnoredRunSkipping", machine->on.second ? std::string() : cngh.generateIgnoredRunSkipping());
 
+	//  - generate the acceleration of self-looping states, again on raw input only
+	std::string selfLoopClasses;
+	std::string selfLoopAcceleration;
+	if (!machine->on.second) {
+		cngh.generateSelfLoopAcceleration(selfLoopClasses, selfLoopAcceleration);
+	}
+	macros.emplace("SelfLoopClasses", selfLoopClasses);
+	macros.emplace("SelfLoopAcceleration", selfLoopAcceleration);
+
+	//  - generate the processing of batches of documents in memory, on raw input only too
+	std::string batchProcessingDeclarations;
+	std::string batchProcessingHelperDeclaration;
+	std::string batchProcessingDefinitions;
+	if (!machine->on.second) {
+		cngh.generateBatchProcessing(batchProcessingDeclarations, batchProcessingHelperDeclaration, batchProcessingDefinitions);
+	}
+	macros.emplace("BatchProcessingDeclarations", batchProcessingDeclarations);
+	macros.emplace("BatchProcessingHelperDeclaration", batchProcessingHelperDeclaration);
+	macros.emplace("BatchProcessingDefinitions", batchProcessingDefinitions);
+
+	//  - generate the recognition of the keywords left out of the automaton
+	std::string keywordRecognitionDeclaration;
+	std::string keywordRecognitionDefinition;
+	cngh.generateKeywordRecognition(keywordRecognitionDeclaration, keywordRecognitionDefinition);
+	macros.emplace("KeywordRecognitionDeclaration", keywordRecognitionDeclaration);
+	macros.emplace("KeywordRecognitionDefinition", keywordRecognitionDefinition);
+
+	std::stringstream faHeader, faCode;
 	GenerationHelper::macroWrite(specimenFaHeaderContents, macros, faHeader);
 	GenerationHelper::macroWrite(specimenFaCodeContents, macros, faCode);
+	GenerationHelper::writeFileIfChanged(m_folderPath / (machine->name + ".h"), faHeader.str());
+	GenerationHelper::writeFileIfChanged(m_folderPath / (machine->name + ".cpp"), faCode.str());
+
+	if (m_emitsInterpretableTables && !machine->on.second) {
+		GenerationHelper::writeFileIfChanged(m_folderPath / (machine->name + ".astirt"), cngh.generateInterpretableTable(*machine), true);
+	}
 }
 
 void CppGenerationVisitor::visit(const LLkParserDefinition* llkParserDefinition) {
@@ -104,17 +257,50 @@ void CppGenerationVisitor::visit(const LLkParserDefinition* llkParserDefinition)
 	if (roots.empty()) {
 		throw GenerationException("The machine '" + llkParserDefinition->name + "' has no root productions and cannot thus be generated", *llkParserDefinition);
 	}
-	CppLLkParserGenerator generator(llkParserDefinition->builder());
+	CppLLkParserGenerator generator(llkParserDefinition->builder(), m_profilesParsers);
 	generator.visitTypeFormingStatements(llkParserDefinition->getTypeFormingStatements());
 	generator.visitRootDisjunction(roots);
 	macros.emplace("ParsingDeclarations", generator.parsingDeclarations());
 	macros.emplace("ParsingDefinitions", generator.parsingDefinitions());
 
+	// the profile of the parse_ functions, see ParserProfiler (each starting a line of its own, so that nothing at all is left behind without profiling)
+	if (m_profilesParsers) {
+		macros.emplace("ProfilerInclude", "\n#include \"ParserProfiler.h\"");
+		macros.emplace("ProfilerDeclaration", "\nconst ParserProfiler& profiler() const { return m_profiler; }\nParserProfiler& profiler() { return m_profiler; }");
+		macros.emplace("ProfilerField", "\nParserProfiler m_profiler = ParserProfiler(" + generator.profilerInitialization() + ");");
+	} else {
+		macros.emplace("ProfilerInclude", "");
+		macros.emplace("ProfilerDeclaration", "");
+		macros.emplace("ProfilerField", "");
+	}
+
+	// the terminals of the `sync` clause, for ParallelParser to split the input right after (starting a line of their own, like the profiler)
+	if (llkParserDefinition->synchronizingTerminals.empty()) {
+		macros.emplace("SynchronizationDeclaration", "");
+		macros.emplace("SynchronizationDefinition", "");
+	} else {
+		macros.emplace("SynchronizationDeclaration", "\nstatic bool isSynchronizing(const InputTypePtr& input);");
+		std::stringstream synchronizationss;
+		synchronizationss << std::endl << "// a new root may only start right after these when parsed in parallel (see ParallelParser)" << std::endl;
+		synchronizationss << "bool " << llkParserDefinition->name << "::isSynchronizing(const InputTypePtr& input) {" << std::endl;
+		synchronizationss << "\treturn ";
+		for (auto synchronizingIt = llkParserDefinition->synchronizingTerminals.cbegin(); synchronizingIt != llkParserDefinition->synchronizingTerminals.cend(); ++synchronizingIt) {
+			if (synchronizingIt != llkParserDefinition->synchronizingTerminals.cbegin()) {
+				synchronizationss << " || ";
+			}
+			synchronizationss << "std::dynamic_pointer_cast<" << llkParserDefinition->on.first << "::" << synchronizingIt->first << ">(input) != nullptr";
+		}
+		synchronizationss << ";" << std::endl;
+		synchronizationss << "}" << std::endl;
+		macros.emplace("SynchronizationDefinition", synchronizationss.str());
+	}
+
 	// write it all out
-	std::ofstream parserHeader(m_folderPath / (llkParserDefinition->name + ".h"));
-	std::ofstream parserCode(m_folderPath / (llkParserDefinition->name + ".cpp"));
+	std::stringstream parserHeader, parserCode;
 	GenerationHelper::macroWrite(specimenParserHeaderContents, macros, parserHeader);
 	GenerationHelper::macroWrite(specimenParserCodeContents, macros, parserCode);
+	GenerationHelper::writeFileIfChanged(m_folderPath / (llkParserDefinition->name + ".h"), parserHeader.str());
+	GenerationHelper::writeFileIfChanged(m_folderPath / (llkParserDefinition->name + ".cpp"), parserCode.str());
 }
 
 void CppGenerationVisitor::visit(const TypeFormingStatement* tfs) {
@@ -209,12 +395,7 @@ void CppGenerationVisitor::buildUniversalMachineMacros(std::map<std::string, std
 	//	- choose appropriate input stream type
 	std::stringstream dependencyHeaderIncludesStream;
 	if (!machine->on.second) {
-		if (!m_hasIncludedRawStreamFiles) {
-			std::filesystem::copy_file("Resources/RawStream.h", m_folderPath / "RawStream.h", std::filesystem::copy_options::overwrite_existing);
-			std::filesystem::copy_file("Resources/RawStream.cpp", m_folderPath / "RawStream.cpp", std::filesystem::copy_options::overwrite_existing);
-
-			m_hasIncludedRawStreamFiles = true;
-		}
+		includeRawStreamFiles();
 		macros.emplace("AppropriateStreamHeader", "RawStream.h");
 		macros.emplace("InputTerminalTypeName", "RawTerminal");
 		macros.emplace("InputStreamTypeName", "RawStream");
@@ -239,7 +420,7 @@ void CppGenerationVisitor::buildUniversalMachineMacros(std::map<std::string, std
 			macros.emplace("InputTypeName", inputTypeName);
 			macros.emplace("InputStreamTypeName", "ProductionStream<" + inputTypeName + ">");
 
-			macros.emplace("CombineRawDeclaration", "std::string combineRaw(const std::deque<" + inputTypeName + "Ptr>& contents);");
+			macros.emplace("CombineRawDeclaration", "static std::string combineRaw(const std::deque<" + inputTypeName + "Ptr>& contents);");
 			std::stringstream combineRawss;
 			combineRawss << "std::string " << machine->name << "::combineRaw(const std::deque<" << inputTypeName << "Ptr>& contents) {" << std::endl;
 			combineRawss << "\tstd::stringstream ss;" << std::endl;
@@ -286,6 +467,18 @@ void CppGenerationVisitor::buildUniversalMachineMacros(std::map<std::string, std
 	ss.str("");
 }
 
+void CppGenerationVisitor::includeRawStreamFiles() {
+	if (!m_hasIncludedRawStreamFiles) {
+		GenerationHelper::copyFileIfChanged("Resources/RawStream.h", m_folderPath / "RawStream.h");
+		GenerationHelper::copyFileIfChanged("Resources/RawStream.cpp", m_folderPath / "RawStream.cpp");
+		GenerationHelper::copyFileIfChanged("Resources/ByteClass.h", m_folderPath / "ByteClass.h");
+		GenerationHelper::copyFileIfChanged("Resources/ByteClass.cpp", m_folderPath / "ByteClass.cpp");
+		GenerationHelper::copyFileIfChanged("Resources/ParallelTokenizer.h", m_folderPath / "ParallelTokenizer.h");
+
+		m_hasIncludedRawStreamFiles = true;
+	}
+}
+
 std::string CppGenerationVisitor::combineForwardDeclarationsAndClear() {
 	std::stringstream ss;
 	for (const auto& forwardDeclaration : m_typeFormingStatementsVisited) {
@@ -8,10 +8,11 @@
 
 class CppGenerationVisitor : public GenerationVisitor {
 public:
-	CppGenerationVisitor(const std::string& folderPath)
-		: GenerationVisitor(folderPath), m_hasIncludedRawStreamFiles(false) { }
+	CppGenerationVisitor(const std::string& folderPath, bool emitsInterpretableTables = false, bool profilesParsers = false)
+		: GenerationVisitor(folderPath), m_hasIncludedRawStreamFiles(false), m_emitsInterpretableTables(emitsInterpretableTables), m_profilesParsers(profilesParsers) { }
 
 	void setup() const override;
+	void markUpToDateMachines(const SyntacticTree* tree) const;
 
 	void visit(const SyntacticTree* tree) override;
 	void visit(const FiniteAutomatonDefinition* tree) override;
@@ -25,6 +26,14 @@ public:
 
 private:
 	void buildUniversalMachineMacros(std::map<std::string, std::string>& macros, const MachineDefinition* machine);
+	void includeRawStreamFiles();
+
+	static constexpr const char* MANIFEST_FILE_NAME = ".astir-manifest";
+	static constexpr const char* MANIFEST_FORMAT_VERSION = "2";
+	// to be bumped with every change to the code the generator emits that the specimens do not show (the generation helpers, the macros), outdating whatever older generators have written
+	static constexpr const char* EMISSION_REVISION = "10";
+	void writeManifest(const SyntacticTree* tree) const;
+	Fingerprint computeGeneratorFingerprint() const;
 	std::string combineForwardDeclarationsAndClear();
 
 	std::stringstream m_output;
@@ -33,5 +42,7 @@ private:
 	std::string outputAndReset();
 
 	bool m_hasIncludedRawStreamFiles;
+	bool m_emitsInterpretableTables; // whether the finite automata on raw input are also written out as tables for the InterpretedAutomaton
+	bool m_profilesParsers; // whether the parsers keep a ParserProfiler of their productions
 };
 
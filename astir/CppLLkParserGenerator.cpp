@@ -3,8 +3,8 @@
 
 #include <algorithm>
 
-CppLLkParserGenerator::CppLLkParserGenerator(LLkBuilder& builder)
-	: LLkParserGenerator(builder) { }
+CppLLkParserGenerator::CppLLkParserGenerator(LLkBuilder& builder, bool profiles)
+	: LLkParserGenerator(builder), m_profiles(profiles) { }
 
 void CppLLkParserGenerator::visitTypeFormingStatements(const std::list<std::shared_ptr<TypeFormingStatement>>& typeFormingStatements) {
 	for (const auto& typeFormingStatementSPtr : typeFormingStatements) {
@@ -20,6 +20,7 @@ void CppLLkParserGenerator::visitRootDisjunction(const std::list<std::shared_ptr
 	m_output.put("std::shared_ptr<OutputProduction> ");
 	m_output << m_builder.contextMachine()->name << "::parse_root(InputStream & is) {" << std::endl;
 	m_output.increaseIndentation();
+	handleProfiling("root");
 	m_output.putln("auto productionStartLocation = is.peek(0)->location()->clone();");
 	m_output.putln("const std::string typeFormingStatementName = \"root\";");
 	m_output.putln("size_t cumulativePeekCorrection = 0;");
@@ -79,7 +80,7 @@ void CppLLkParserGenerator::visit(const CategoryStatement* category) {
 
 	// core
 	if (category->references.empty()) {
-		m_output.putln("return std::make_shared<" + category->name + ">(productionStartLocation);");
+		m_output.putln("return makeAccounted<" + category->name + ">(\"" + m_builder.contextMachine()->name + "::" + category->name + "\", productionStartLocation);");
 	} else {
 		std::vector<LLkDecisionPoint> decisionPoints;
 		decisionPoints.reserve(category->references.size());
@@ -363,13 +364,39 @@ std::string CppLLkParserGenerator::parsingDeclarations() const {
 	return ss.str();
 }
 
+std::string CppLLkParserGenerator::profilerInitialization() const {
+	std::stringstream ss;
+	ss << "{ ";
+	for (const auto& productionName : m_profiledProductions) {
+		ss << '"' << productionName << "\", ";
+	}
+	ss << "}";
+	return ss.str();
+}
+
+void CppLLkParserGenerator::handleProfiling(const std::string& productionName) {
+	if (!m_profiles) {
+		return;
+	}
+
+	m_output.putln("ParserProfiler::Scope profilingScope(m_profiler, " + std::to_string(m_profiledProductions.size()) + ");");
+	m_profiledProductions.push_back(productionName);
+}
+
+std::string CppLLkParserGenerator::makePeekIndex(unsigned long depth) const {
+	// the decisions of profiled productions note how far they peek
+	const std::string index = "cumulativePeekCorrection+" + std::to_string(depth);
+	return m_profiles ? "profilingScope.lookahead(" + index + ")" : index;
+}
+
 void CppLLkParserGenerator::handleTypeFormingPreamble(const std::string& typeName) {
 	m_output.put("std::shared_ptr<");
 	m_output << typeName << "> " << m_builder.contextMachine()->name << "::parse_" << typeName << "(InputStream& is) {" << std::endl;
 	m_output.increaseIndentation();
+	handleProfiling(typeName);
 	m_output.putln("auto productionStartLocation = is.peek(0)->location()->clone();");
 	m_output.putln("const std::string typeFormingStatementName = \"" + typeName + "\";");
-	m_output.putln("std::shared_ptr<" + typeName + "> typeFormingStatement = std::make_shared<" + typeName + ">(productionStartLocation);");
+	m_output.putln("std::shared_ptr<" + typeName + "> typeFormingStatement = makeAccounted<" + typeName + ">(\"" + m_builder.contextMachine()->name + "::" + typeName + "\", productionStartLocation);");
 	m_output.putln("size_t cumulativePeekCorrection = 0;");
 	m_output.newline();
 }
@@ -451,13 +478,13 @@ std::string CppLLkParserGenerator::makeCondition(const std::shared_ptr<SymbolGro
 
 	const ByteSymbolGroup* bytePtr = dynamic_cast<const ByteSymbolGroup*>(rawPtr);
 	if (bytePtr != nullptr) {
-		output << "is.peek(cumulativePeekCorrection+" << depth << ")->raw.length() == 1 && is.peek(cumulativePeekCorrection+" << depth << ")->raw[0] >= " << bytePtr->rangeStart << " && is.peek(cumulativePeekCorrection+" << depth << ")->raw[0] <= " << bytePtr->rangeEnd;
+		output << "is.peek(" << makePeekIndex(depth) << ")->raw.length() == 1 && is.peek(" << makePeekIndex(depth) << ")->raw[0] >= " << bytePtr->rangeStart << " && is.peek(" << makePeekIndex(depth) << ")->raw[0] <= " << bytePtr->rangeEnd;
 		return output.str();
 	}
 
 	const LiteralSymbolGroup* literalPtr = dynamic_cast<const LiteralSymbolGroup*>(rawPtr);
 	if (literalPtr != nullptr) {
-		output << "is.peek(cumulativePeekCorrection+" << depth << ")->raw == \"" << literalPtr->literal << "\"";
+		output << "is.peek(" << makePeekIndex(depth) << ")->raw == \"" << literalPtr->literal << "\"";
 		return output.str();
 	}
 
@@ -465,12 +492,12 @@ std::string CppLLkParserGenerator::makeCondition(const std::shared_ptr<SymbolGro
 	if (ssgPtr != nullptr) {
 		if (ssgPtr->statementMachine == this->m_builder.contextMachine()->on.second.get()) {
 			// the input comes from "on"
-			output << "std::dynamic_pointer_cast<" << (ssgPtr->statementMachine != m_builder.contextMachine() ? ssgPtr->statementMachine->name + "::" : "") << ssgPtr->statement->name << ">(is.peek(cumulativePeekCorrection+" << depth << "))";
+			output << "std::dynamic_pointer_cast<" << (ssgPtr->statementMachine != m_builder.contextMachine() ? ssgPtr->statementMachine->name + "::" : "") << ssgPtr->statement->name << ">(is.peek(" << makePeekIndex(depth) << "))";
 		} else {
 			// the input comes from an "uses" machine
 			output << "m_" << ssgPtr->statementMachine->name << ".peekCast<";
 			output << (ssgPtr->statementMachine != m_builder.contextMachine() ? ssgPtr->statementMachine->name + "::" : "");
-			output << ssgPtr->statement->name << ">(is, cumulativePeekCorrection+" << depth << ", cumulativePeekCorrection)";
+			output << ssgPtr->statement->name << ">(is, " << makePeekIndex(depth) << ", cumulativePeekCorrection)";
 			postamble = "m_" + ssgPtr->statementMachine->name + ".unpeekIfApplicable(is, cumulativePeekCorrection)";
 		}
 
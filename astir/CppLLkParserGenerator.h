@@ -5,7 +5,7 @@
 
 class CppLLkParserGenerator : public LLkParserGenerator {
 public:
-	CppLLkParserGenerator(LLkBuilder& builder);
+	CppLLkParserGenerator(LLkBuilder& builder, bool profiles = false);
 
 	void visitTypeFormingStatements(const std::list<std::shared_ptr<TypeFormingStatement>>& rootDisjunction) override;
 	void visitRootDisjunction(const std::list<std::shared_ptr<TypeFormingStatement>>& typeFormingStatements) override;
@@ -29,8 +29,11 @@ public:
 
 	std::string parsingDeclarations() const;
 	std::string parsingDefinitions() const { return m_output.str(); }
+	std::string profilerInitialization() const; // the names of the productions profiled, in the order of their indices (see ParserProfiler)
 
 private:
+	void handleProfiling(const std::string& productionName);
+	std::string makePeekIndex(unsigned long depth) const;
 	void handleTypeFormingPreamble(const std::string& typeName);
 	void handleTypeFormingPostamble();
 	void handleRuleBody(const RuleStatement* rule);
@@ -45,4 +48,7 @@ private:
 
 	IndentedStringStream m_output;
 	std::list<std::string> m_declarations;
+
+	bool m_profiles; // whether every parse_ function is to open a ParserProfiler::Scope
+	std::vector<std::string> m_profiledProductions;
 };
\ No newline at end of file
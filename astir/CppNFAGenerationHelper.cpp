@@ -1,20 +1,42 @@
 #include "CppNFAGenerationHelper.h"
 
 #include <sstream>
+#include <algorithm>
+#include <map>
+#include <cctype>
 
 #include "SyntacticTree.h"
 #include "MachineDefinition.h"
 #include "MachineStatement.h"
 #include "Field.h"
+#include "ConstructionSerializer.h"
+#include "FiniteAutomatonDefinition.h"
 
-void CppNFAGenerationHelper::generateMechanicsMaps(std::string& stateMap, std::string& actionRegisterDeclarations, std::string& actionRegisterDefinitions, std::string& transitionActionMap, std::string& stateActionMap) const {
+void CppNFAGenerationHelper::generateMechanicsMaps(std::string& stateMap, std::string& actionRegisterTypeName, std::string& actionRegisterCases, std::string& transitionActionMap, std::string& stateActionMap) const {
 	std::stringstream stateMapStream;
-	std::stringstream actionRegisterDeclarationStream;
-	std::stringstream actionRegisterDefinitionStream;
+	std::stringstream actionRegisterCaseStream;
 	std::stringstream transitionActionMapStream;
 
-	// counter for action registers
-	ActionRegisterId actionRegistersUsed = 0;
+	// identical action registers share a single case of the action register switch, looked up by the code generated for them
+	std::map<std::string, ActionRegisterId> actionRegisterIds;
+	size_t actionRegistersRequested = 0;
+	auto registerActions = [this, &actionRegisterIds, &actionRegistersRequested, &actionRegisterCaseStream](const NFAActionRegister& nar) -> ActionRegisterId {
+		if (nar.empty()) {
+			return (ActionRegisterId)0;
+		}
+
+		++actionRegistersRequested;
+		std::string operations = generateActionOperations(nar);
+		auto it = actionRegisterIds.find(operations);
+		if (it != actionRegisterIds.end()) {
+			return it->second;
+		}
+
+		ActionRegisterId registerId = (ActionRegisterId)actionRegisterIds.size() + 1;
+		actionRegisterCaseStream << generateActionRegisterCase(registerId, operations);
+		actionRegisterIds.emplace(std::move(operations), registerId);
+		return registerId;
+	};
 
 	// the entire state action-register map, 0 (to be nullptr) by default
 	std::vector<ActionRegisterId> stateActionRegisterMap(m_fa.states.size(), (ActionRegisterId)0);
@@ -29,14 +51,7 @@ void CppNFAGenerationHelper::generateMechanicsMaps(std::string& stateMap, std::s
 		std::vector<std::vector<ActionRegisterId>> transitionActionRegisterMapLine(m_inputTerminalCount, std::vector<ActionRegisterId>());
 
 		// handle the action register of state actions
-		const NFAActionRegister& snar = stateObject.actions;
-		if (snar.size() > 0) {
-			ActionRegisterId registerId = ++actionRegistersUsed;
-			actionRegisterDeclarationStream << generateActionRegisterDeclaration(registerId, snar);
-			actionRegisterDefinitionStream << generateActionRegisterDefinition(registerId, snar);
-
-			stateActionRegisterMap[state] = registerId;
-		}
+		stateActionRegisterMap[state] = registerActions(stateObject.actions);
 
 		for (const auto& transition : stateObject.transitions) {
 			auto simpleSymbolGroup = std::dynamic_pointer_cast<SymbolGroup>(transition.condition);
@@ -47,16 +62,7 @@ void CppNFAGenerationHelper::generateMechanicsMaps(std::string& stateMap, std::s
 			}
 
 			// handle the action register of transition actions
-			const NFAActionRegister& tnar = transition.actions;
-			ActionRegisterId createdRegisterId;
-			if (tnar.size() > 0) {
-				createdRegisterId = ++actionRegistersUsed;
-				actionRegisterDeclarationStream << generateActionRegisterDeclaration(createdRegisterId, tnar);
-				actionRegisterDefinitionStream << generateActionRegisterDefinition(createdRegisterId, tnar);
-			} else {
-				createdRegisterId = 0;
-			}
-
+			ActionRegisterId createdRegisterId = registerActions(transition.actions);
 			for (SymbolIndex symbolIndex : *conditionSymbolIndices) {
 				auto offsetMapLine = transitionActionRegisterMapLine.begin() + symbolIndex;
 				offsetMapLine->push_back(createdRegisterId);
@@ -77,11 +83,7 @@ void CppNFAGenerationHelper::generateMechanicsMaps(std::string& stateMap, std::s
 		for (const std::vector<ActionRegisterId>& actionMapEntryVector : transitionActionRegisterMapLine) {
 			transitionActionMapStream << "{ ";
 			for (auto it = actionMapEntryVector.crbegin(); it != actionMapEntryVector.crend(); ++it) {
-				if (*it == (ActionRegisterId)0) {
-					transitionActionMapStream << "nullptr, ";
-				} else {
-					transitionActionMapStream << "&actionRegister" << *it << ", ";
-				}
+				transitionActionMapStream << *it << ", ";
 			}
 			transitionActionMapStream << "}, ";
 		}
@@ -90,21 +92,51 @@ void CppNFAGenerationHelper::generateMechanicsMaps(std::string& stateMap, std::s
 
 	std::stringstream stateActionMapStream;
 	for (State state = 0; state < m_fa.states.size(); ++state) {
-		if (stateActionRegisterMap[state] == (ActionRegisterId)0) {
-			stateActionMapStream << "nullptr, ";
-		} else {
-			stateActionMapStream << "&actionRegister" << stateActionRegisterMap[state] << ", ";
-		}
+		stateActionMapStream << stateActionRegisterMap[state] << ", ";
 	}
 
 	stateMap = stateMapStream.str();
-	actionRegisterDeclarations = actionRegisterDeclarationStream.str();
-	actionRegisterDefinitions = actionRegisterDefinitionStream.str();
+	// the action register ids are stored in the action maps, so the narrowest type that fits them all is used
+	if (actionRegisterIds.size() <= 0xFF) {
+		actionRegisterTypeName = "unsigned char";
+	} else if (actionRegisterIds.size() <= 0xFFFF) {
+		actionRegisterTypeName = "unsigned short";
+	} else {
+		actionRegisterTypeName = "unsigned int";
+	}
+	actionRegisterCases = "// " + std::to_string(actionRegisterIds.size()) + " action registers shared by the " + std::to_string(actionRegistersRequested) + " states and transitions with actions\n" + actionRegisterCaseStream.str();
 	transitionActionMap = transitionActionMapStream.str();
 	stateActionMap = stateActionMapStream.str();
 
 }
 
+void CppNFAGenerationHelper::measureMechanicsMaps(size_t& tableByteCount, size_t& actionRegisterCount) const {
+	std::set<std::string> actionRegisters;
+	size_t stateEntryCount = 0;
+	size_t actionEntryCount = 0;
+	for (const auto& stateObject : m_fa.states) {
+		if (!stateObject.actions.empty()) {
+			actionRegisters.insert(generateActionOperations(stateObject.actions));
+		}
+
+		for (const auto& transition : stateObject.transitions) {
+			const size_t symbolCount = transition.condition->retrieveSymbolIndices()->size();
+			stateEntryCount += symbolCount;
+			actionEntryCount += symbolCount;
+			if (!transition.actions.empty()) {
+				actionRegisters.insert(generateActionOperations(transition.actions));
+			}
+		}
+	}
+	actionRegisterCount = actionRegisters.size();
+
+	// a vector of targets and one of action registers in every cell, the registers of the narrowest type generateMechanicsMaps picks, and the finality and action register of every state
+	const size_t actionRegisterSize = actionRegisterCount <= 0xFF ? 1 : (actionRegisterCount <= 0xFFFF ? 2 : 4);
+	tableByteCount = m_fa.states.size() * m_inputTerminalCount * (sizeof(std::vector<State>) + sizeof(std::vector<unsigned char>))
+		+ stateEntryCount * sizeof(State) + actionEntryCount * actionRegisterSize
+		+ m_fa.states.size() * (sizeof(bool) + actionRegisterSize);
+}
+
 std::string CppNFAGenerationHelper::generateContextDeclarations() const {
 	std::stringstream ss;
 
@@ -129,28 +161,503 @@ std::string CppNFAGenerationHelper::generateStateFinality() const {
 	return ss.str();
 }
 
-std::string CppNFAGenerationHelper::generateActionRegisterDeclaration(ActionRegisterId registerId, const NFAActionRegister& nar) const {
-	std::stringstream actionRegisterDeclarationStream;
+std::string CppNFAGenerationHelper::generateIgnoredRunSkipping() const {
+	// the candidates are the bytes the root tokens (as created on leaving the initial state) can start with
+	std::map<std::string, std::set<SymbolIndex>> candidateRuns;
+	for (const auto& transition : m_fa.states[0].transitions) {
+		for (const auto& action : transition.actions) {
+			if (action.type == NFAActionType::CreateContext && action.contextPath == "m_token") {
+				auto symbolIndices = transition.condition->retrieveSymbolIndices();
+				candidateRuns[action.targetName].insert(symbolIndices->cbegin(), symbolIndices->cend());
+			}
+		}
+	}
+
+	std::stringstream ss;
+	size_t runCount = 0;
+	for (const auto& candidateRunPair : candidateRuns) {
+		State endState;
+		if (!isIgnoredRun(candidateRunPair.second, endState)) {
+			continue;
+		}
+
+		++runCount;
+		ss << "\tstatic const ByteClass ignoredRun" << runCount << "({ ";
+		for (SymbolIndex symbolIndex : candidateRunPair.second) {
+			ss << symbolIndex << ", ";
+		}
+		ss << "}); // " << candidateRunPair.first << std::endl;
+		ss << "\tif (rs.skipWhile(ignoredRun" << runCount << ") > 0) {" << std::endl;
+		ss << "\t\tstate.m_currentState = " << endState << ";" << std::endl;
+		ss << "\t\treturn nullptr;" << std::endl;
+		ss << "\t}" << std::endl;
+	}
+
+	if (runCount == 0) {
+		return std::string();
+	}
+	return "// the runs of bytes that can make up nothing but a single ignored token are skipped in one go\nif (state.m_currentState == 0) {\n" + ss.str() + "}\n";
+}
+
+void CppNFAGenerationHelper::generateSelfLoopAcceleration(std::string& selfLoopClasses, std::string& selfLoopAcceleration) const {
+	std::stringstream classStream;
+	std::stringstream accelerationStream;
+
+	for (State state = 0; state < m_fa.states.size(); ++state) {
+		std::set<SymbolIndex> loop = findSelfLoop(state);
+		if (loop.empty()) {
+			continue;
+		}
+
+		classStream << "static const ByteClass selfLoop" << state << "({ ";
+		for (SymbolIndex symbolIndex : loop) {
+			classStream << symbolIndex << ", ";
+		}
+		classStream << "});" << std::endl;
+		accelerationStream << "\tcase " << state << ": rs.advanceWhile(selfLoop" << state << "); break;" << std::endl;
+	}
+
+	selfLoopClasses = classStream.str();
+	if (selfLoopClasses.empty()) {
+		selfLoopAcceleration = std::string();
+	} else {
+		selfLoopClasses = "// the bytes the states loop on themselves over\n" + selfLoopClasses;
+		selfLoopAcceleration = "// the states looping on themselves read through the runs of the bytes they loop over in one go\nswitch(state.m_currentState) {\n" + accelerationStream.str() + "}\n";
+	}
+}
+
+std::set<SymbolIndex> CppNFAGenerationHelper::findSelfLoop(State state) const {
+	const auto& stateObject = m_fa.states[state];
+	if (!stateObject.actions.empty()) {
+		return std::set<SymbolIndex>();
+	}
+
+	// the targets for every byte, in the order the generated automaton tries them in (the state map has them reversed)
+	std::vector<std::vector<const Transition*>> cells(m_inputTerminalCount);
+	for (const auto& transition : stateObject.transitions) {
+		for (SymbolIndex symbolIndex : *transition.condition->retrieveSymbolIndices()) {
+			cells[symbolIndex].push_back(&transition);
+		}
+	}
+
+	// on the bytes of the loop, the state has to go back to itself without any actions, but only once all the other targets have been tried, and those have to be dead ends
+	// reading the run of such bytes then only leaves behind what the last of them does, so all the others can be read through with no regard to the tables
+	// for the same reason, either all or none of the bytes of the loop must lead to final dead ends, lest the accepting state be left behind by one of those read through
+	std::set<SymbolIndex> loopToFinalDeadEnds, loopToOtherDeadEnds;
+	for (SymbolIndex symbolIndex = 0; symbolIndex < cells.size(); ++symbolIndex) {
+		const auto& cell = cells[symbolIndex];
+		if (cell.empty() || cell.back()->target != state || !cell.back()->actions.empty()) {
+			continue;
+		}
+
+		bool toDeadEndsOnly = true;
+		bool toFinalDeadEnd = false;
+		for (auto it = cell.cbegin(); it + 1 != cell.cend(); ++it) {
+			State target = (*it)->target;
+			toDeadEndsOnly = toDeadEndsOnly && target != state && m_fa.states[target].transitions.empty();
+			toFinalDeadEnd = toFinalDeadEnd || m_fa.finalStates.count(target) > 0;
+		}
+
+		if (toDeadEndsOnly) {
+			(toFinalDeadEnd ? loopToFinalDeadEnds : loopToOtherDeadEnds).insert(symbolIndex);
+		}
+	}
+
+	return loopToFinalDeadEnds.size() >= loopToOtherDeadEnds.size() ? loopToFinalDeadEnds : loopToOtherDeadEnds;
+}
+
+bool CppNFAGenerationHelper::isIgnoredRun(const std::set<SymbolIndex>& run, State& endState) const {
+	auto elevates = [](const NFAActionRegister& nar) {
+		return std::any_of(nar.cbegin(), nar.cend(), [](const NFAAction& action) { return action.type == NFAActionType::ElevateContext; });
+	};
+	auto stepOn = [this](const std::set<State>& stateSet, SymbolIndex symbolIndex) {
+		std::set<State> ret;
+		for (State state : stateSet) {
+			for (const auto& transition : m_fa.states[state].transitions) {
+				auto symbolIndices = transition.condition->retrieveSymbolIndices();
+				if (std::find(symbolIndices->cbegin(), symbolIndices->cend(), symbolIndex) != symbolIndices->cend()) {
+					ret.insert(transition.target);
+				}
+			}
+		}
+		return ret;
+	};
+
+	// the tokens that can start with the bytes of the run must not get elevated, i.e. must be ignored
+	if (elevates(m_fa.states[0].actions)) {
+		return false;
+	}
+	for (const auto& transition : m_fa.states[0].transitions) {
+		auto symbolIndices = transition.condition->retrieveSymbolIndices();
+		if (elevates(transition.actions) && std::any_of(symbolIndices->cbegin(), symbolIndices->cend(), [&run](SymbolIndex symbolIndex) { return run.count(symbolIndex) > 0; })) {
+			return false;
+		}
+	}
+
+	// go through all the sets of states the automaton can be in (across all of its branches) after having read a run of the bytes
+	// in every one of them the automaton has to be able to accept, to go on with any byte of the run, and to not go on with anything else,
+	// so that whatever the run, it is always read as a whole as a single ignored token
+	std::set<std::set<State>> explored;
+	std::deque<std::set<State>> toExplore;
+	for (SymbolIndex symbolIndex : run) {
+		toExplore.push_back(stepOn({ 0 }, symbolIndex));
+	}
+
+	bool endStateFound = false;
+	while (!toExplore.empty()) {
+		std::set<State> stateSet = std::move(toExplore.front());
+		toExplore.pop_front();
+		if (!explored.insert(stateSet).second) {
+			continue;
+		} else if (explored.size() > MAX_EXPLORED_IGNORED_RUN_STATE_SETS) {
+			return false;
+		}
+
+		bool accepts = false;
+		for (State state : stateSet) {
+			const auto& stateObject = m_fa.states[state];
+			if (elevates(stateObject.actions)) {
+				return false;
+			}
+			for (const auto& transition : stateObject.transitions) {
+				auto symbolIndices = transition.condition->retrieveSymbolIndices();
+				if (elevates(transition.actions) || std::any_of(symbolIndices->cbegin(), symbolIndices->cend(), [&run](SymbolIndex symbolIndex) { return run.count(symbolIndex) == 0; })) {
+					return false;
+				}
+			}
+
+			if (m_fa.finalStates.count(state) > 0) {
+				accepts = true;
+				if (!endStateFound) {
+					endState = state;
+					endStateFound = true;
+				}
+			}
+		}
+		if (!accepts) {
+			return false;
+		}
+
+		for (SymbolIndex symbolIndex : run) {
+			std::set<State> nextStateSet = stepOn(stateSet, symbolIndex);
+			if (nextStateSet.empty()) {
+				return false;
+			}
+			toExplore.push_back(std::move(nextStateSet));
+		}
+	}
+
+	return endStateFound;
+}
+
+std::string CppNFAGenerationHelper::generateInterpretableTable(const MachineDefinition& machine) const {
+	ConstructionWriter writer;
+	writer.writeSize(INTERPRETABLE_TABLE_FORMAT_VERSION);
+	writer.writeString(m_machineName);
+
+	// terminal types keep the indices of the generated terminal type enumeration, the other type-forming statements follow
+	std::vector<std::string> typeNames(machine.terminalProductionCount() + 1);
+	typeNames[0] = "EOS";
+	for (const auto& typeFormingStatement : machine.getTypeFormingStatements()) {
+		auto productionStatement = std::dynamic_pointer_cast<ProductionStatement>(typeFormingStatement);
+		if (productionStatement && productionStatement->terminality == Terminality::Terminal) {
+			typeNames[productionStatement->terminalTypeIndex] = productionStatement->name;
+		} else {
+			typeNames.push_back(typeFormingStatement->name);
+		}
+	}
+	writer.writeSize(typeNames.size());
+	for (const std::string& typeName : typeNames) {
+		writer.writeString(typeName);
+	}
+
+	// the action registers are numbered (and shared) in the same way as the generated action register methods are
+	std::vector<const NFAActionRegister*> actionRegisters;
+	std::map<std::string, uint64_t> actionRegisterIds;
+	auto registerActions = [this, &actionRegisters, &actionRegisterIds](const NFAActionRegister& nar) -> uint64_t {
+		if (nar.empty()) {
+			return 0;
+		}
+		auto it = actionRegisterIds.emplace(generateActionOperations(nar), actionRegisters.size() + 1);
+		if (it.second) {
+			actionRegisters.push_back(&nar);
+		}
+		return it.first->second;
+	};
+
+	writer.writeSize(m_fa.states.size());
+	for (State state = 0; state < m_fa.states.size(); ++state) {
+		const auto& stateObject = m_fa.states[state];
+		writer.writeByte(m_fa.finalStates.count(state) > 0 ? 1 : 0);
+		writer.writeSize(registerActions(stateObject.actions));
+
+		std::vector<std::vector<std::pair<State, uint64_t>>> cells(m_inputTerminalCount);
+		for (const auto& transition : stateObject.transitions) {
+			uint64_t registerId = registerActions(transition.actions);
+			for (SymbolIndex symbolIndex : *transition.condition->retrieveSymbolIndices()) {
+				cells[symbolIndex].emplace_back(transition.target, registerId);
+			}
+		}
+
+		writer.writeSize(std::count_if(cells.cbegin(), cells.cend(), [](const auto& cell) { return !cell.empty(); }));
+		for (SymbolIndex symbolIndex = 0; symbolIndex < cells.size(); ++symbolIndex) {
+			const auto& cell = cells[symbolIndex];
+			if (cell.empty()) {
+				continue;
+			}
+
+			// reversed, just like in the generated state map
+			writer.writeByte((uint8_t)symbolIndex);
+			writer.writeSize(cell.size());
+			for (auto it = cell.crbegin(); it != cell.crend(); ++it) {
+				writer.writeSize(it->first);
+				writer.writeSize(it->second);
+			}
+		}
+	}
+
+	writer.writeSize(actionRegisters.size());
+	for (const NFAActionRegister* nar : actionRegisters) {
+		writer.writeSize(nar->size());
+		for (const auto& action : *nar) {
+			writer.writeByte((uint8_t)action.type);
+			writer.writeString(action.contextPath);
+			writer.writeString(action.targetName);
+			writer.writeString(action.payload);
+		}
+	}
+
+	// the interpreter simply looks the hashed keywords up by the identifier type and the text
+	writer.writeSize(m_hashedKeywords.size());
+	for (const HashedKeyword& hashedKeyword : m_hashedKeywords) {
+		writer.writeSize(hashedKeyword.identifier->terminalTypeIndex);
+		writer.writeString(hashedKeyword.literal);
+		writer.writeSize(hashedKeyword.keyword->terminalTypeIndex);
+	}
+
+	return std::string(INTERPRETABLE_TABLE_MAGIC) + writer.data();
+}
+
+void CppNFAGenerationHelper::generateBatchProcessing(std::string& batchProcessingDeclarations, std::string& batchProcessingHelperDeclaration, std::string& batchProcessingDefinitions) const {
+	const std::string documentsParameters = "const std::vector<std::pair<const char*, const char*>>& documents, const std::shared_ptr<Location>& startingLocation, Sink&& sink";
+
+	std::stringstream declarations;
+	declarations << "// tokenize many (typically short) documents already in memory one after another, reusing the stream, the run state and all their buffers" << std::endl;
+	declarations << "// sink(documentIndex, production) is given whatever processStream (or processStreamWithIgnorance) would give for each of the documents, in that order" << std::endl;
+	declarations << "template <typename Sink>" << std::endl;
+	declarations << "void processBatch(" << documentsParameters << ") { processBatch(documents, startingLocation, sink, m_runState); }" << std::endl;
+	declarations << "template <typename Sink>" << std::endl;
+	declarations << "void processBatch(" << documentsParameters << ", RunState& state) const { processBatch(documents, startingLocation, sink, state, false); }" << std::endl;
+	declarations << "template <typename Sink>" << std::endl;
+	declarations << "void processBatchWithIgnorance(" << documentsParameters << ") { processBatchWithIgnorance(documents, startingLocation, sink, m_runState); }" << std::endl;
+	declarations << "template <typename Sink>" << std::endl;
+	declarations << "void processBatchWithIgnorance(" << documentsParameters << ", RunState& state) const { processBatch(documents, startingLocation, sink, state, true); }" << std::endl;
+	batchProcessingDeclarations = declarations.str();
+
+	batchProcessingHelperDeclaration = "template <typename Sink>\nvoid processBatch(" + documentsParameters + ", RunState& state, bool withIgnorance) const;";
+
+	std::stringstream definitions;
+	definitions << "template <typename Sink>" << std::endl;
+	definitions << "inline void " << m_machineName << "::processBatch(" << documentsParameters << ", RunState& state, bool withIgnorance) const {" << std::endl;
+	definitions << "	if (documents.empty()) {" << std::endl;
+	definitions << "		return;" << std::endl;
+	definitions << "	}" << std::endl;
+	definitions << std::endl;
+	definitions << "	MemoryStream ms(documents.front().first, documents.front().second, startingLocation);" << std::endl;
+	definitions << "	for (size_t documentIndex = 0; documentIndex < documents.size(); ++documentIndex) {" << std::endl;
+	definitions << "		if (documentIndex > 0) {" << std::endl;
+	definitions << "			ms.reset(documents[documentIndex].first, documents[documentIndex].second, startingLocation);" << std::endl;
+	definitions << "		}" << std::endl;
+	definitions << "		reset(state);" << std::endl;
+	definitions << "		ASTIR_TRACE(\"processBatch\", \"tokenize\");" << std::endl;
+	definitions << std::endl;
+	definitions << "		// just like processStream does it" << std::endl;
+	definitions << "		bool wasLastApplicationSuccessful;" << std::endl;
+	definitions << "		do {" << std::endl;
+	definitions << "			auto production = apply(ms, state);" << std::endl;
+	definitions << "			if (production || !withIgnorance) {" << std::endl;
+	definitions << "				sink(documentIndex, production);" << std::endl;
+	definitions << "			}" << std::endl;
+	definitions << "			wasLastApplicationSuccessful = lastApplicationSuccessful(state);" << std::endl;
+	definitions << "			if (wasLastApplicationSuccessful) {" << std::endl;
+	definitions << "				reset(state);" << std::endl;
+	definitions << "			}" << std::endl;
+	definitions << "		} while (wasLastApplicationSuccessful && ms.good());" << std::endl;
+	definitions << "	}" << std::endl;
+	definitions << "}" << std::endl;
+	batchProcessingDefinitions = definitions.str();
+}
+
+void CppNFAGenerationHelper::generateKeywordRecognition(std::string& keywordRecognitionDeclaration, std::string& keywordRecognitionDefinition) const {
+	if (m_hashedKeywords.empty()) {
+		keywordRecognitionDeclaration = std::string();
+		keywordRecognitionDefinition = std::string();
+		return;
+	}
+
+	std::vector<uint32_t> seeds;
+	std::vector<const HashedKeyword*> slots;
+	buildKeywordHashTable(seeds, slots);
+
+	keywordRecognitionDeclaration = "static std::shared_ptr<OutputProduction> recognizeKeyword(const std::shared_ptr<OutputTerminal>& identifier);";
+
+	std::stringstream ss;
+	ss << "static uint32_t hashKeyword(const std::string& text, uint32_t seed) {" << std::endl;
+	ss << "\tuint32_t hash = 2166136261u ^ (seed * 2654435769u);" << std::endl;
+	ss << "\tfor (char character : text) {" << std::endl;
+	ss << "\t\thash = (hash ^ (unsigned char)character) * 16777619u;" << std::endl;
+	ss << "\t}" << std::endl;
+	ss << "\thash ^= hash >> 16;" << std::endl;
+	ss << "\thash *= 2246822507u;" << std::endl;
+	ss << "\treturn hash ^ (hash >> 13);" << std::endl;
+	ss << "}" << std::endl;
+	ss << std::endl;
+
+	ss << "// the keywords left out of the automaton are recognized among the tokens of their identifiers by a minimal perfect hash of the text" << std::endl;
+	ss << "std::shared_ptr<OutputProduction> " << m_machineName << "::recognizeKeyword(const std::shared_ptr<OutputTerminal>& identifier) {" << std::endl;
+	ss << "\tstruct Keyword {" << std::endl;
+	ss << "\t\tconst char* text;" << std::endl;
+	ss << "\t\tsize_t length;" << std::endl;
+	ss << "\t\tOutputTerminalType identifierType;" << std::endl;
+	ss << "\t\tOutputTerminalType keywordType;" << std::endl;
+	ss << "\t};" << std::endl;
+	ss << "\t// the first hash of the text picks the seed of the second one, which gives the slot" << std::endl;
+	ss << "\tstatic const uint32_t seeds[" << seeds.size() << "] = { ";
+	for (uint32_t seed : seeds) {
+		ss << seed << ", ";
+	}
+	ss << "};" << std::endl;
+	ss << "\tstatic const Keyword keywords[" << slots.size() << "] = {" << std::endl;
+	for (const HashedKeyword* slot : slots) {
+		if (slot == nullptr) {
+			ss << "\t\t{ \"\", 0, OutputTerminalType::EOS, OutputTerminalType::EOS }," << std::endl;
+			continue;
+		}
+
+		ss << "\t\t{ \"";
+		for (char character : slot->literal) {
+			if (std::isalnum((unsigned char)character) || character == '_' || character == ' ') {
+				ss << character;
+			} else {
+				// octal escapes take no more than three digits, so whatever follows can not be mistaken for a part of them
+				ss << '\\' << (char)('0' + (((unsigned char)character >> 6) & 7)) << (char)('0' + (((unsigned char)character >> 3) & 7)) << (char)('0' + ((unsigned char)character & 7));
+			}
+		}
+		ss << "\", " << slot->literal.length() << ", OutputTerminalType::" << slot->identifier->name << ", OutputTerminalType::" << slot->keyword->name << " }," << std::endl;
+	}
+	ss << "\t};" << std::endl;
+	ss << std::endl;
+	ss << "\tconst std::string& text = identifier->raw;" << std::endl;
+	ss << "\tconst Keyword& keyword = keywords[hashKeyword(text, seeds[hashKeyword(text, 0) % " << seeds.size() << "]) % " << slots.size() << "];" << std::endl;
+	ss << "\tif (keyword.identifierType != identifier->type || keyword.length != text.length() || text.compare(0, text.length(), keyword.text, keyword.length) != 0) {" << std::endl;
+	ss << "\t\treturn identifier;" << std::endl;
+	ss << "\t}" << std::endl;
+	ss << std::endl;
+	ss << "\tstd::shared_ptr<OutputTerminal> recognized;" << std::endl;
+	ss << "\tswitch (keyword.keywordType) {" << std::endl;
+	for (const HashedKeyword& hashedKeyword : m_hashedKeywords) {
+		ss << "\t\tcase OutputTerminalType::" << hashedKeyword.keyword->name << ":" << std::endl;
+		ss << "\t\t\trecognized = makeAccounted<" << hashedKeyword.keyword->name << ">(\"" << m_machineName << "::" << hashedKeyword.keyword->name << "\", identifier->location());" << std::endl;
+		ss << "\t\t\tbreak;" << std::endl;
+	}
+	ss << "\t\tdefault:" << std::endl;
+	ss << "\t\t\treturn identifier;" << std::endl;
+	ss << "\t}" << std::endl;
+	ss << "\trecognized->raw = text;" << std::endl;
+	ss << "\treturn recognized;" << std::endl;
+	ss << "}" << std::endl;
+
+	keywordRecognitionDefinition = ss.str();
+}
+
+uint32_t CppNFAGenerationHelper::hashKeyword(const std::string& text, uint32_t seed) {
+	// FNV-1a from a seeded offset basis, with the high bits mixed into the low ones that the modulo keeps
+	uint32_t hash = 2166136261u ^ (seed * 2654435769u);
+	for (char character : text) {
+		hash = (hash ^ (unsigned char)character) * 16777619u;
+	}
+	hash ^= hash >> 16;
+	hash *= 2246822507u;
+	return hash ^ (hash >> 13);
+}
+
+void CppNFAGenerationHelper::buildKeywordHashTable(std::vector<uint32_t>& seeds, std::vector<const HashedKeyword*>& slots) const {
+	// hash and displace: the keywords are split into buckets by the first hash, and every bucket, the fullest first, looks for a seed of the second hash that sends all its keywords to free slots
+	// with as many slots as there are keywords, the table is minimal -- should no seeds be found for it (which is next to impossible), a slot is added and the search starts over
+	const size_t keywordCount = m_hashedKeywords.size();
+	for (size_t slotCount = keywordCount; ; ++slotCount) {
+		const size_t bucketCount = keywordCount;
+		std::vector<std::vector<const HashedKeyword*>> buckets(bucketCount);
+		for (const HashedKeyword& hashedKeyword : m_hashedKeywords) {
+			buckets[hashKeyword(hashedKeyword.literal, 0) % bucketCount].push_back(&hashedKeyword);
+		}
 
-	actionRegisterDeclarationStream
-		<< "void actionRegister" << registerId
-		<< "(size_t position, const std::deque<InputTerminalPtr>& input, const std::shared_ptr<Location>& location);"
-		<< std::endl
-		;
+		std::vector<size_t> bucketOrder(bucketCount);
+		for (size_t bucket = 0; bucket < bucketCount; ++bucket) {
+			bucketOrder[bucket] = bucket;
+		}
+		std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&buckets](size_t lhs, size_t rhs) { return buckets[lhs].size() > buckets[rhs].size(); });
+
+		seeds.assign(bucketCount, 0);
+		slots.assign(slotCount, nullptr);
+		bool allPlaced = true;
+		for (size_t bucket : bucketOrder) {
+			if (buckets[bucket].empty()) {
+				break;
+			}
 
-	return actionRegisterDeclarationStream.str();
+			bool placed = false;
+			for (uint32_t seed = 1; seed < MAX_KEYWORD_HASH_SEED && !placed; ++seed) {
+				std::set<size_t> bucketSlots;
+				placed = true;
+				for (const HashedKeyword* hashedKeyword : buckets[bucket]) {
+					size_t slot = hashKeyword(hashedKeyword->literal, seed) % slotCount;
+					if (slots[slot] != nullptr || !bucketSlots.insert(slot).second) {
+						placed = false;
+						break;
+					}
+				}
+
+				if (placed) {
+					seeds[bucket] = seed;
+					for (const HashedKeyword* hashedKeyword : buckets[bucket]) {
+						slots[hashKeyword(hashedKeyword->literal, seed) % slotCount] = hashedKeyword;
+					}
+				}
+			}
+
+			if (!placed) {
+				allPlaced = false;
+				break;
+			}
+		}
+
+		if (allPlaced) {
+			return;
+		}
+	}
 }
 
-std::string CppNFAGenerationHelper::generateActionRegisterDefinition(ActionRegisterId registerId, const NFAActionRegister& nar) const {
+bool CppNFAGenerationHelper::isKeywordIdentifier(const std::string& productionName) const {
+	return std::any_of(m_hashedKeywords.cbegin(), m_hashedKeywords.cend(), [&productionName](const HashedKeyword& hashedKeyword) { return hashedKeyword.identifier->name == productionName; });
+}
+
+std::string CppNFAGenerationHelper::generateActionRegisterCase(ActionRegisterId registerId, const std::string& operations) const {
 	std::stringstream ss;
-	ss << "void " << m_machineName << "::" << "actionRegister" << registerId << "(size_t position, const std::deque<InputTerminalPtr>& input, const std::shared_ptr<Location>& location) {" << std::endl;
+	ss << "case " << registerId << ": {" << std::endl;
+	ss << operations;
+	ss << "\tbreak;" << std::endl;
+	ss << "}" << std::endl;
+
+	return ss.str();
+}
 
+std::string CppNFAGenerationHelper::generateActionOperations(const NFAActionRegister& nar) const {
+	std::stringstream ss;
 	for (const auto& action : nar) {
 		ss << generateActionOperation(action);
 	}
 
-	ss << "}" << std::endl << std::endl;
-
 	return ss.str();
 }
 
@@ -214,7 +721,7 @@ std::string CppNFAGenerationHelper::generateActionOperation(const NFAAction& na)
 			break;
 
 		case NFAActionType::CreateContext:
-			output << na.contextPath << "__" << na.targetName << " = std::make_shared<" << na.targetName << ">(location);" << std::endl;
+			output << na.contextPath << "__" << na.targetName << " = makeAccounted<" << na.targetName << ">(\"" << m_machineName << "::" << na.targetName << "\", location);" << std::endl;
 			output << "\tm_captureStack.push(position);" << std::endl;
 			break;
 		case NFAActionType::TerminalizeContext:
@@ -229,7 +736,12 @@ std::string CppNFAGenerationHelper::generateActionOperation(const NFAAction& na)
 			output << "\t}" << std::endl;
 			break;
 		case NFAActionType::ElevateContext:
-			output << na.contextPath << " = " << na.contextPath << "__" << na.targetName << ';' << std::endl;
+			if (na.contextPath == "m_token" && isKeywordIdentifier(na.targetName)) {
+				// the token may turn out to be one of the keywords left out of the automaton
+				output << na.contextPath << " = recognizeKeyword(" << na.contextPath << "__" << na.targetName << ");" << std::endl;
+			} else {
+				output << na.contextPath << " = " << na.contextPath << "__" << na.targetName << ';' << std::endl;
+			}
 			break;
 		case NFAActionType::IgnoreContext:
 			output << na.contextPath << "__" << na.targetName << " = nullptr;" << std::endl;
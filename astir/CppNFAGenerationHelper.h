@@ -1,26 +1,52 @@
 #pragma once
 
 #include <string>
+#include <set>
+#include <list>
+#include <vector>
+#include <cstdint>
 
 #include "NFA.h"
 
+struct MachineDefinition;
+struct HashedKeyword;
+
 using ActionRegisterId = unsigned long;
 
 class CppNFAGenerationHelper {
 public:
-	CppNFAGenerationHelper(const std::string& machineName, const NFA& fa, const size_t inputTerminalCount)
-		: m_machineName(machineName), m_fa(fa), m_inputTerminalCount(inputTerminalCount) { }
+	CppNFAGenerationHelper(const std::string& machineName, const NFA& fa, const size_t inputTerminalCount, const std::list<HashedKeyword>& hashedKeywords)
+		: m_machineName(machineName), m_fa(fa), m_inputTerminalCount(inputTerminalCount), m_hashedKeywords(hashedKeywords) { }
 
-	void generateMechanicsMaps(std::string& stateMap, std::string& actionRegisterDeclarations, std::string& actionRegisterDefinitions, std::string& transitionActionMap, std::string& stateActionMap) const;
+	void generateMechanicsMaps(std::string& stateMap, std::string& actionRegisterTypeName, std::string& actionRegisterCases, std::string& transitionActionMap, std::string& stateActionMap) const;
+	void measureMechanicsMaps(size_t& tableByteCount, size_t& actionRegisterCount) const; // how much memory the maps generateMechanicsMaps generates take in the generated code, for the statistics
 	std::string generateContextDeclarations() const;
 	std::string generateStateFinality() const;
+	std::string generateIgnoredRunSkipping() const; // for automata on raw input only
+	void generateSelfLoopAcceleration(std::string& selfLoopClasses, std::string& selfLoopAcceleration) const; // for automata on raw input only
+	void generateKeywordRecognition(std::string& keywordRecognitionDeclaration, std::string& keywordRecognitionDefinition) const; // empty unless there are hashed keywords
+	void generateBatchProcessing(std::string& batchProcessingDeclarations, std::string& batchProcessingHelperDeclaration, std::string& batchProcessingDefinitions) const; // for automata on raw input only
+	std::string generateInterpretableTable(const MachineDefinition& machine) const; // for the InterpretedAutomaton of the runtime, see Resources/InterpretedAutomaton.h
 private:
+	static constexpr const char* INTERPRETABLE_TABLE_MAGIC = "ASTIRT";
+	static constexpr uint64_t INTERPRETABLE_TABLE_FORMAT_VERSION = 2;
+	static constexpr size_t MAX_EXPLORED_IGNORED_RUN_STATE_SETS = 256;
+	static constexpr uint32_t MAX_KEYWORD_HASH_SEED = 1 << 16;
+
 	const std::string& m_machineName;
 	const NFA& m_fa;
 	const size_t m_inputTerminalCount;
+	const std::list<HashedKeyword>& m_hashedKeywords;
+
+	// the seeded hash of keyword texts, the generated code computes the very same one
+	static uint32_t hashKeyword(const std::string& text, uint32_t seed);
+	void buildKeywordHashTable(std::vector<uint32_t>& seeds, std::vector<const HashedKeyword*>& slots) const;
+	bool isKeywordIdentifier(const std::string& productionName) const;
 
-	std::string generateActionRegisterDeclaration(ActionRegisterId registerId, const NFAActionRegister& nar) const;
-	std::string generateActionRegisterDefinition(ActionRegisterId registerId, const NFAActionRegister& nar) const;
+	std::set<SymbolIndex> findSelfLoop(State state) const;
+	bool isIgnoredRun(const std::set<SymbolIndex>& run, State& endState) const;
+	std::string generateActionRegisterCase(ActionRegisterId registerId, const std::string& operations) const;
+	std::string generateActionOperations(const NFAActionRegister& nar) const;
 	std::string generateActionOperation(const NFAAction& na) const;
 };
 
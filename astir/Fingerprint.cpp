@@ -0,0 +1,44 @@
+#include "Fingerprint.h"
+
+#include <sstream>
+#include <iomanip>
+
+FingerprintBuilder& FingerprintBuilder::operator<<(const std::string& data) {
+	// the length goes first so that e.g. "ab" "c" and "a" "bc" do not end up the same
+	*this << (Fingerprint)data.length();
+	feed(data.c_str(), data.length());
+	return *this;
+}
+
+FingerprintBuilder& FingerprintBuilder::operator<<(Fingerprint fingerprint) {
+	for (size_t byteIndex = 0; byteIndex < sizeof(Fingerprint); ++byteIndex) {
+		const char byte = (char)((fingerprint >> (8 * byteIndex)) & 0xFF);
+		feed(&byte, 1);
+	}
+	return *this;
+}
+
+Fingerprint FingerprintBuilder::of(const std::string& data) {
+	FingerprintBuilder builder;
+	builder << data;
+	return builder.value();
+}
+
+std::string FingerprintBuilder::toString(Fingerprint fingerprint) {
+	std::stringstream ss;
+	ss << std::hex << std::setw(16) << std::setfill('0') << fingerprint;
+	return ss.str();
+}
+
+bool FingerprintBuilder::fromString(const std::string& str, Fingerprint& fingerprint) {
+	std::stringstream ss(str);
+	ss >> std::hex >> fingerprint;
+	return !ss.fail() && ss.eof();
+}
+
+void FingerprintBuilder::feed(const char* data, size_t length) {
+	for (size_t index = 0; index < length; ++index) {
+		m_value ^= (unsigned char)data[index];
+		m_value *= 1099511628211ULL;
+	}
+}
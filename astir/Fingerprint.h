@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+using Fingerprint = std::uint64_t;
+
+/*
+	A 64-bit FNV-1a content hash, used to tell whether a machine definition or a generated file has changed between two runs.
+	It is not meant to withstand anyone trying to make it collide.
+*/
+class FingerprintBuilder {
+public:
+	FingerprintBuilder()
+		: m_value(14695981039346656037ULL) { }
+
+	FingerprintBuilder& operator<<(const std::string& data);
+	FingerprintBuilder& operator<<(Fingerprint fingerprint);
+
+	Fingerprint value() const { return m_value; }
+
+	static Fingerprint of(const std::string& data);
+	static std::string toString(Fingerprint fingerprint);
+	static bool fromString(const std::string& str, Fingerprint& fingerprint);
+
+private:
+	Fingerprint m_value;
+
+	void feed(const char* data, size_t length);
+};
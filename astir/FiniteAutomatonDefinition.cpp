@@ -3,6 +3,11 @@
 #include "SemanticAnalysisException.h"
 #include "NFABuilder.h"
 #include "GenerationVisitor.h"
+#include "ConstructionSerializer.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
 
 void FiniteAutomatonDefinition::initialize() {
 	if (initialized()) { // really necessary
@@ -15,6 +20,10 @@ void FiniteAutomatonDefinition::initialize() {
 		throw SemanticAnalysisException("The machine '" + name + "' declared at " + locationString() + " `uses` at least one other machine -- finite automata using other machines is not supported, but the finite automaton can still be `on` input from some other machine");
 	}
 
+	if (!this->synchronizingTerminals.empty()) {
+		throw SemanticAnalysisException("The machine '" + name + "' declared at " + locationString() + " lists terminals to synchronize at in the `sync` clause -- only parsers can be run in parallel that way, finite automata on raw input can be run by ParallelTokenizer instead");
+	}
+
 	// check for any signs of recursion
 	for (const auto& statementPair : statements) {
 		std::list<IReferencingCPtr> relevantReferencesEncountered;
@@ -35,11 +44,111 @@ void FiniteAutomatonDefinition::initialize() {
 		}
 	}
 
+	if (attributes.find(MachineFlag::KeywordsHashed)->second.value && !this->on.second) {
+		findHashedKeywords();
+	}
+
+	if (isUpToDate()) {
+		return;
+	}
+
+	if (!restoreCachedConstruction()) {
+		const auto constructionStart = std::chrono::steady_clock::now();
+		const NFA nfa = buildNFA(true);
+		m_nfaStateCount = nfa.states.size();
+		m_nfaTransitionCount = nfa.transitionCount();
+		m_nfa = nfa.buildPseudoDFA();
+		recordConstruction(constructionStart);
+	}
+
+	// cheap next to the construction, so not worth caching
+	m_backtracking = BacktrackingAnalysis::analyze(m_nfa);
+}
+
+void FiniteAutomatonDefinition::findHashedKeywords() {
+	std::list<std::pair<std::shared_ptr<ProductionStatement>, std::string>> keywordCandidates;
+	std::list<std::shared_ptr<ProductionStatement>> identifierCandidates;
+	for (const auto& typeFormingStatement : this->getTypeFormingStatements()) {
+		auto productionStatement = std::dynamic_pointer_cast<ProductionStatement>(typeFormingStatement);
+		if (!productionStatement || productionStatement->terminality != Terminality::Terminal || productionStatement->rootness != Rootness::AcceptRoot) {
+			continue;
+		}
+
+		// a keyword is a plain sequence of bytes, with nothing captured, flagged, or categorized on the way
+		std::string literal;
+		bool isKeywordShaped = productionStatement->fields.empty() && productionStatement->categories.empty()
+			&& productionStatement->regex->actions.empty() && productionStatement->regex->disjunction.size() == 1;
+		if (isKeywordShaped) {
+			for (const auto& rootRegex : productionStatement->regex->disjunction.front()->conjunction) {
+				auto literalRegex = dynamic_cast<const LiteralRegex*>(rootRegex.get());
+				if (!literalRegex || !literalRegex->actions.empty() || literalRegex->literal.length() != 1) {
+					isKeywordShaped = false;
+					break;
+				}
+				literal += literalRegex->literal;
+			}
+		}
+
+		if (isKeywordShaped && !literal.empty()) {
+			keywordCandidates.emplace_back(productionStatement, literal);
+		} else {
+			identifierCandidates.push_back(productionStatement);
+		}
+	}
+
+	// every keyword goes to the first identifier whose tokens it may be one of, those matched by none are left in the automaton
+	std::map<const ProductionStatement*, NFA> identifierAutomata;
+	std::set<std::string> literalsHashed;
+	for (const auto& keywordCandidate : keywordCandidates) {
+		if (!literalsHashed.insert(keywordCandidate.second).second) {
+			continue;
+		}
+
+		for (const auto& identifierCandidate : identifierCandidates) {
+			auto automatonIt = identifierAutomata.find(identifierCandidate.get());
+			if (automatonIt == identifierAutomata.end()) {
+				NFABuilder builder(*this, nullptr, "m_token");
+				NFA identifierNfa = std::dynamic_pointer_cast<INFABuildable>(identifierCandidate)->accept(builder);
+				automatonIt = identifierAutomata.emplace(identifierCandidate.get(), identifierNfa.buildPseudoDFA()).first;
+			}
+
+			// any of the paths through the pseudo-DFA may do
+			const NFA& identifierAutomaton = automatonIt->second;
+			std::set<State> states({ 0 });
+			for (char literalCharacter : keywordCandidate.second) {
+				std::set<State> nextStates;
+				for (State state : states) {
+					for (const auto& transition : identifierAutomaton.states[state].transitions) {
+						const auto symbolIndices = transition.condition->retrieveSymbolIndices();
+						if (std::find(symbolIndices->cbegin(), symbolIndices->cend(), (SymbolIndex)(unsigned char)literalCharacter) != symbolIndices->cend()) {
+							nextStates.insert(transition.target);
+						}
+					}
+				}
+				states = std::move(nextStates);
+			}
+
+			if (std::any_of(states.cbegin(), states.cend(), [&identifierAutomaton](State state) { return identifierAutomaton.finalStates.count(state) > 0; })) {
+				m_hashedKeywords.push_back({ keywordCandidate.second, keywordCandidate.first, identifierCandidate });
+				break;
+			}
+		}
+	}
+}
+
+NFA FiniteAutomatonDefinition::buildNFA(bool leavingOutHashedKeywords) const {
+	std::set<const TypeFormingStatement*> leftOut;
+	if (leavingOutHashedKeywords) {
+		for (const auto& hashedKeyword : m_hashedKeywords) {
+			leftOut.insert(hashedKeyword.keyword.get());
+		}
+	}
+
 	NFA base;
 	NFABuilder builder(*this, nullptr, "m_token");
 	auto typeFormingStatement = this->getTypeFormingStatements();
 	for (const auto& typeFormingStatement : typeFormingStatement) {
-		if (typeFormingStatement->rootness == Rootness::Unspecified) {
+		if (typeFormingStatement->rootness == Rootness::Unspecified || leftOut.count(typeFormingStatement.get()) > 0) {
 			continue;
 		}
 
@@ -67,7 +176,21 @@ void FiniteAutomatonDefinition::initialize() {
 		base |= alternativeNfa;
 	}
 
-	m_nfa = base.buildPseudoDFA();
+	return base;
+}
+
+bool FiniteAutomatonDefinition::storeConstruction(ConstructionWriter& writer) const {
+	writer.writeNFA(m_nfa);
+	return true;
+}
+
+void FiniteAutomatonDefinition::restoreConstruction(ConstructionReader& reader) {
+	m_nfa = reader.readNFA();
+}
+
+size_t FiniteAutomatonDefinition::measureUnhashedStateCount() const {
+	// the automaton with the keywords in it is only built so that the generation can report what the hashing spares
+	return m_hashedKeywords.empty() ? m_nfa.states.size() : buildNFA(false).buildPseudoDFA().states.size();
 }
 
 void FiniteAutomatonDefinition::accept(GenerationVisitor* visitor) const {
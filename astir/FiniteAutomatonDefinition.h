@@ -2,6 +2,17 @@
 
 #include "SyntacticTree.h"
 #include "MachineDefinition.h"
+#include "BacktrackingAnalysis.h"
+
+/*
+	A keyword-shaped terminal root, i.e. one made of a plain string literal, that the automaton with the keywords_hashed attribute leaves out.
+	Its literal is matched as a token of the identifier production instead, and the token is then told to be the keyword by the generated perfect hash.
+*/
+struct HashedKeyword {
+	std::string literal;
+	std::shared_ptr<ProductionStatement> keyword;
+	std::shared_ptr<ProductionStatement> identifier;
+};
 
 struct FiniteAutomatonDefinition : public MachineDefinition {
 	FiniteAutomatonDefinition()
@@ -9,15 +20,32 @@ struct FiniteAutomatonDefinition : public MachineDefinition {
 				{ MachineFlag::ProductionsTerminalByDefault, MachineDefinitionAttribute(true) },
 				{ MachineFlag::ProductionsRootByDefault, MachineDefinitionAttribute(true) },
 				{ MachineFlag::CategoriesRootByDefault, MachineDefinitionAttribute(false) },
-				{ MachineFlag::AmbiguityResolvedByPrecedence, MachineDefinitionAttribute(false) }
-			}) { }
+				{ MachineFlag::AmbiguityResolvedByPrecedence, MachineDefinitionAttribute(false) },
+				{ MachineFlag::KeywordsHashed, MachineDefinitionAttribute(false) }
+			}), m_nfaStateCount(0), m_nfaTransitionCount(0) { }
 
 	void initialize() override;
 
 	const NFA& getNFA() const { return m_nfa; }
+	const std::list<HashedKeyword>& getHashedKeywords() const { return m_hashedKeywords; }
+	size_t measureUnhashedStateCount() const; // how many states the automaton would have had with the hashed keywords in it, which takes building that automaton
+	size_t nfaStateCount() const { return m_nfaStateCount; } // of the nondeterministic automaton the pseudo-DFA has been built from, 0 if it has not been built
+	size_t nfaTransitionCount() const { return m_nfaTransitionCount; }
+	const BacktrackingAnalysis& backtracking() const { return m_backtracking; } // of the pseudo-DFA, as recorded in the manifest if the machine is up to date
+	void restoreBacktracking(const BacktrackingAnalysis& backtracking) { m_backtracking = backtracking; } // of a machine up to date, which is not analyzed again
+	bool storeConstruction(ConstructionWriter& writer) const override;
 
 	void accept(GenerationVisitor* visitor) const override;
+protected:
+	void restoreConstruction(ConstructionReader& reader) override;
 private:
 	std::shared_ptr<const FiniteAutomatonDefinition> m_finiteAutomatonDefinition;
 	NFA m_nfa;
+	std::list<HashedKeyword> m_hashedKeywords;
+	size_t m_nfaStateCount;
+	size_t m_nfaTransitionCount;
+	BacktrackingAnalysis m_backtracking;
+
+	void findHashedKeywords();
+	NFA buildNFA(bool leavingOutHashedKeywords) const;
 };
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 #include "GenerationException.h"
 
+#include <fstream>
+#include <iterator>
+
 void GenerationHelper::macroWrite(const std::string& sourceString, const std::map<std::string, std::string>& macroPairs, std::ostream& m_output) {
 	size_t it = 0;
 	unsigned long lastIndentation = 0;
@@ -82,3 +85,29 @@ void GenerationHelper::macroWrite(const std::string& sourceString, const std::ma
 	m_output.write(sourceString.c_str() + it, sourceString.length()-it);
 	m_output.flush();
 }
+
+std::string GenerationHelper::readFile(const std::filesystem::path& path, bool binary) {
+	std::ifstream file(path, binary ? std::ios::in | std::ios::binary : std::ios::in);
+	return std::string((std::istreambuf_iterator<char>(file)), (std::istreambuf_iterator<char>()));
+}
+
+bool GenerationHelper::writeFileIfChanged(const std::filesystem::path& path, const std::string& contents, bool binary) {
+	if (std::filesystem::exists(path) && readFile(path, binary) == contents) {
+		return false;
+	}
+
+	std::ofstream file(path, binary ? std::ios::out | std::ios::binary : std::ios::out);
+	if (!file) {
+		throw GenerationException("The file '" + path.string() + "' could not be opened for writing");
+	}
+	file << contents;
+	return true;
+}
+
+bool GenerationHelper::copyFileIfChanged(const std::filesystem::path& sourcePath, const std::filesystem::path& targetPath) {
+	if (!std::filesystem::exists(sourcePath)) {
+		throw GenerationException("The resource file '" + sourcePath.string() + "' could not be found");
+	}
+
+	return writeFileIfChanged(targetPath, readFile(sourcePath, true), true);
+}
@@ -3,11 +3,17 @@
 #include <string>
 #include <map>
 #include <ostream>
+#include <filesystem>
 
 class GenerationHelper {
 public:
 	static void macroWrite(const std::string& sourceString, const std::map<std::string, std::string>& macroPairs, std::ostream& m_output);
 
+	// the following leave files whose contents would not change untouched, so that their timestamps do not trigger needless recompilation
+	static std::string readFile(const std::filesystem::path& path, bool binary = false);
+	static bool writeFileIfChanged(const std::filesystem::path& path, const std::string& contents, bool binary = false);
+	static bool copyFileIfChanged(const std::filesystem::path& sourcePath, const std::filesystem::path& targetPath);
+
 private:
 	GenerationHelper() = default;
 };
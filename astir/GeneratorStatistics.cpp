@@ -0,0 +1,121 @@
+#include "GeneratorStatistics.h"
+
+#include "SyntacticTree.h"
+#include "FiniteAutomatonDefinition.h"
+#include "LLkParserDefinition.h"
+#include "CppNFAGenerationHelper.h"
+#include "GeneratorTrace.h"
+#include "PeakMemory.h"
+#include "Resources/TraceEvents.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+void GeneratorStatistics::beginPhase(const std::string& name) {
+	endPhase();
+	m_currentPhase = name;
+	m_phaseStart = std::chrono::steady_clock::now();
+}
+
+void GeneratorStatistics::endPhase() {
+	if (m_currentPhase.empty()) {
+		return;
+	}
+
+	m_phases.emplace_back(m_currentPhase, std::chrono::steady_clock::now() - m_phaseStart);
+	if (m_trace != nullptr) {
+		m_trace->record(m_currentPhase, "phase", m_phaseStart, m_phases.back().second);
+	}
+	m_currentPhase.clear();
+}
+
+void GeneratorStatistics::write(std::ostream& output, const SyntacticTree* tree) const {
+	std::chrono::steady_clock::duration pseudoDFABuildingDuration = std::chrono::steady_clock::duration::zero();
+	std::chrono::steady_clock::duration llkBuildingDuration = std::chrono::steady_clock::duration::zero();
+	std::stringstream machinesStream;
+	machinesStream << std::setprecision(6) << std::fixed;
+	bool firstMachine = true;
+	for (const auto& machineDefinitionPair : tree->machineDefinitions) {
+		const MachineDefinition* machine = machineDefinitionPair.second.get();
+		machinesStream << (firstMachine ? "\n" : ",\n") << "    " << quote(machine->name) << ": { ";
+		firstMachine = false;
+
+		auto finiteAutomaton = dynamic_cast<const FiniteAutomatonDefinition*>(machine);
+		auto llkParser = dynamic_cast<const LLkParserDefinition*>(machine);
+		if (finiteAutomaton != nullptr) {
+			machinesStream << "\"type\": \"finite automaton\"";
+			pseudoDFABuildingDuration += machine->constructionDuration();
+		} else if (llkParser != nullptr) {
+			machinesStream << "\"type\": \"LL(" << llkParser->k() << ") parser\"";
+			llkBuildingDuration += machine->constructionDuration();
+		}
+		machinesStream << ", \"upToDate\": " << (machine->isUpToDate() ? "true" : "false")
+			<< ", \"restoredFromCache\": " << (machine->isRestoredFromCache() ? "true" : "false")
+			<< ", \"constructionSeconds\": " << seconds(machine->constructionDuration());
+
+		// recorded in the manifest for up-to-date machines
+		if (finiteAutomaton != nullptr) {
+			const BacktrackingAnalysis& backtracking = finiteAutomaton->backtracking();
+			machinesStream << ", \"maxRollback\": ";
+			if (backtracking.rollbackBounded) {
+				machinesStream << backtracking.maxRollback;
+			} else {
+				machinesStream << "null";
+			}
+			machinesStream << ", \"maxBranchingFactor\": " << backtracking.maxBranchingFactor << ", \"branchingCells\": " << backtracking.branchingCells;
+		}
+
+		// up-to-date machines are not built at all, and the cache only holds the pseudo-DFAs, not the automata they have been built from
+		if (machine->isUpToDate()) {
+			machinesStream << " }";
+			continue;
+		}
+
+		if (finiteAutomaton != nullptr) {
+			const NFA& dfa = finiteAutomaton->getNFA();
+			if (!machine->isRestoredFromCache()) {
+				machinesStream << ", \"nfaStates\": " << finiteAutomaton->nfaStateCount() << ", \"nfaTransitions\": " << finiteAutomaton->nfaTransitionCount();
+			}
+
+			const size_t inputTerminalCount = machine->on.second ? machine->on.second->terminalProductionCount() + 1 : 256;
+			size_t tableByteCount, actionRegisterCount;
+			CppNFAGenerationHelper(machine->name, dfa, inputTerminalCount, finiteAutomaton->getHashedKeywords()).measureMechanicsMaps(tableByteCount, actionRegisterCount);
+			machinesStream << ", \"dfaStates\": " << dfa.states.size() << ", \"dfaTransitions\": " << dfa.transitionCount()
+				<< ", \"tableBytes\": " << tableByteCount << ", \"actionRegisters\": " << actionRegisterCount
+				<< ", \"hashedKeywords\": " << finiteAutomaton->getHashedKeywords().size();
+		} else if (llkParser != nullptr) {
+			size_t maxDecisionDepth = 0;
+			for (const auto& flyweightPair : llkParser->builder().flyweights()) {
+				maxDecisionDepth = std::max(maxDecisionDepth, flyweightPair.second.decisions.maxDepth());
+			}
+			machinesStream << ", \"decisionPoints\": " << llkParser->builder().flyweights().size() << ", \"maxDecisionDepth\": " << maxDecisionDepth;
+		}
+		machinesStream << " }";
+	}
+
+	output << std::setprecision(6) << std::fixed;
+	output << "{\n  \"phases\": {";
+	bool firstPhase = true;
+	auto writePhase = [&output, &firstPhase](const std::string& name, std::chrono::steady_clock::duration duration) {
+		output << (firstPhase ? "\n" : ",\n") << "    " << quote(name) << ": " << seconds(duration);
+		firstPhase = false;
+	};
+	for (const auto& phasePair : m_phases) {
+		writePhase(phasePair.first, phasePair.second);
+	}
+	writePhase("pseudoDFABuilding", pseudoDFABuildingDuration);
+	writePhase("llkBuilding", llkBuildingDuration);
+	output << "\n  },\n"
+		<< "  \"peakMemoryBytes\": " << peakResidentBytes() << ",\n"
+		<< "  \"machines\": {" << machinesStream.str() << "\n  }\n"
+		<< "}\n";
+}
+
+std::string GeneratorStatistics::quote(const std::string& text) {
+	return TraceEventWriter::quote(text);
+}
+
+double GeneratorStatistics::seconds(std::chrono::steady_clock::duration duration) {
+	return std::chrono::duration<double>(duration).count();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <utility>
+
+struct SyntacticTree;
+class GeneratorTrace;
+
+/*
+	The report of `--stats`: how long every phase of a run of the generator took, how much memory the run peaked at, and how large the machines it has built are, written out as JSON.
+	The machines are built concurrently during the semantic initialization, so the building of pseudo-DFAs and LL(k) decision trees is reported as the sum of the construction times of the individual machines,
+	which may well add up to more than the initialization itself took.
+*/
+class GeneratorStatistics {
+public:
+	GeneratorStatistics()
+		: m_phaseStart(std::chrono::steady_clock::now()), m_trace(nullptr) { }
+
+	void traceTo(GeneratorTrace* trace) { m_trace = trace; } // the phases are then also recorded as spans of the trace
+	void beginPhase(const std::string& name); // ends the phase begun last, if any
+	void endPhase();
+
+	void write(std::ostream& output, const SyntacticTree* tree) const;
+
+	static std::string quote(const std::string& text); // as a JSON string
+
+private:
+	std::vector<std::pair<std::string, std::chrono::steady_clock::duration>> m_phases;
+	std::string m_currentPhase;
+	std::chrono::steady_clock::time_point m_phaseStart;
+	GeneratorTrace* m_trace;
+
+	static double seconds(std::chrono::steady_clock::duration duration);
+};
@@ -0,0 +1,21 @@
+#include "GeneratorTrace.h"
+
+#include "Resources/TraceEvents.h"
+
+void GeneratorTrace::record(const std::string& name, const std::string& category, Clock::time_point start, Clock::duration duration) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const size_t thread = m_threads.emplace(std::this_thread::get_id(), m_threads.size()).first->second;
+	m_events.push_back({ name, category, start, duration, thread });
+}
+
+void GeneratorTrace::write(std::ostream& output) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	TraceEventWriter::begin(output);
+	for (size_t thread = 0; thread < m_threads.size(); ++thread) {
+		TraceEventWriter::writeThreadName(output, thread == 0, thread, thread == 0 ? "main" : "worker " + std::to_string(thread));
+	}
+	for (const auto& event : m_events) {
+		TraceEventWriter::writeSpan(output, false, event.name, event.category, event.thread, event.start - m_origin, event.duration);
+	}
+	TraceEventWriter::end(output);
+}
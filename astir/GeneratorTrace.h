@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+	The timeline of `--trace`: the phases of a run of the generator and, within them, the initialization, the building of the pseudo-DFA or LL(k) decision trees, and the emission of every machine,
+	each on the thread it ran on, written out as Chrome trace-event JSON to be inspected in a trace viewer (chrome://tracing, Perfetto).
+	Spans may be recorded from any number of threads at once; those given no trace (nullptr) record nothing.
+*/
+class GeneratorTrace {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	class Span {
+	public:
+		Span(GeneratorTrace* trace, const std::string& name, const std::string& category)
+			: m_trace(trace), m_name(name), m_category(category), m_start(Clock::now()) { }
+		Span(const Span&) = delete;
+		Span& operator=(const Span&) = delete;
+		~Span() {
+			if (m_trace != nullptr) {
+				m_trace->record(m_name, m_category, m_start, Clock::now() - m_start);
+			}
+		}
+
+	private:
+		GeneratorTrace* m_trace;
+		std::string m_name;
+		std::string m_category;
+		Clock::time_point m_start;
+	};
+
+	GeneratorTrace()
+		: m_threads({ { std::this_thread::get_id(), 0 } }), m_origin(Clock::now()) { }
+
+	void record(const std::string& name, const std::string& category, Clock::time_point start, Clock::duration duration); // as a span of the calling thread
+	void write(std::ostream& output) const;
+
+private:
+	struct Event {
+		std::string name;
+		std::string category;
+		Clock::time_point start;
+		Clock::duration duration;
+		size_t thread;
+	};
+
+	mutable std::mutex m_mutex;
+	std::vector<Event> m_events;
+	std::map<std::thread::id, size_t> m_threads; // the main thread first, the workers numbered in the order they have first recorded a span
+	Clock::time_point m_origin;
+};
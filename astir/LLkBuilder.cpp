@@ -6,7 +6,7 @@
 #include "LLkParserDefinition.h"
 
 LLkBuilder::LLkBuilder(const LLkParserDefinition* context)
-	: m_contextMachine(context), m_firster(context) {}
+	: m_contextMachine(context), m_firster(context), m_followEvaluationDepth(0), m_followCycleDepth(NO_FOLLOW_CYCLE) {}
 
 void LLkBuilder::visitRootDisjunction(const std::list<std::shared_ptr<TypeFormingStatement>>& rootDisjunction) {
 	std::list<ILLkNonterminalCPtr> disjunction;
@@ -197,6 +197,11 @@ void LLkBuilder::fillDisambiguationParent(ILLkNonterminalCPtr parent, const std:
 	}*/
 }
 
+void LLkBuilder::restoreFlyweights(std::map<ILLkNonterminalCPtr, LLkFlyweight>&& flyweights) {
+	m_flyweights = std::move(flyweights);
+	m_followMemo.clear();
+}
+
 SymbolGroupList LLkBuilder::lookahead(ILLkFirstableCPtr firstable, const SymbolGroupList& prefix) {
 	if (prefix.size() >= m_contextMachine->k()) {
 		throw SemanticAnalysisException("Lookahead of " + std::to_string(m_contextMachine->k()) + " is insufficient, need to look further ahead");
@@ -235,26 +240,71 @@ SymbolGroupList LLkBuilder::lookahead(ILLkFirstableCPtr firstable, const SymbolG
 
 	auto lookaheadSymbols = firstable->first(&m_firster, prefix);
 	if (lookaheadSymbols.containsEmpty()) {
-		SymbolGroupList emptyPrefix;
 		lookaheadSymbols.removeEmpty();
-		for(const auto& context : flyweight.contexts) {
+		lookaheadSymbols += follow(nonterminal);
+
+		if (followIsApproximate()) {
+			// built on top of a context cycle that is still being evaluated -- don't commit it to the decision tree just yet
+			return lookaheadSymbols;
+		}
+	}
+
+	for (const auto& lookaheadSymbol : lookaheadSymbols) {
+		currentDecisionPoint->transitions.push_back(std::make_shared<LLkTransition>(lookaheadSymbol));
+	}
+
+	return lookaheadSymbols;
+}
+
+SymbolGroupList LLkBuilder::follow(ILLkNonterminalCPtr nonterminal) {
+	auto fit = m_followMemo.find(nonterminal);
+	if (fit != m_followMemo.end()) {
+		if (!fit->second.complete) {
+			// re-entered while still being evaluated, i.e. the contexts form a cycle -- carry on with the current approximation
+			m_followCycleDepth = std::min(m_followCycleDepth, fit->second.evaluationDepth);
+		}
+		return fit->second.symbols.clone();
+	}
+
+	LLkFollowMemoEntry& entry = m_followMemo[nonterminal];
+	entry.evaluationDepth = m_followEvaluationDepth++;
+	const size_t outerCycleDepth = m_followCycleDepth;
+
+	// the approximation only ever grows, so iterate until it stops doing so if this very evaluation was re-entered
+	const auto& contexts = m_flyweights[nonterminal].contexts;
+	SymbolGroupList emptyPrefix;
+	bool approximationGrew;
+	do {
+		m_followCycleDepth = NO_FOLLOW_CYCLE;
+		SymbolGroupList followSymbols;
+		for (const auto& context : contexts) {
 			const auto& followedBy = context.followedBy;
 			auto followedByIt = followedBy.begin();
 			auto furtherLookaheadDueToFollows = sequentialLookahead(followedByIt, followedBy.end(), emptyPrefix);
-			lookaheadSymbols += furtherLookaheadDueToFollows;
-			
+			followSymbols += furtherLookaheadDueToFollows;
+
 			if (followedByIt == followedBy.end()) {
 				auto furtherLookaheadDueToParent = this->lookahead(context.parent, emptyPrefix);
-				lookaheadSymbols += furtherLookaheadDueToParent;
+				followSymbols += furtherLookaheadDueToParent;
 			}
 		}
-	}
 
-	for (const auto& lookaheadSymbol : lookaheadSymbols) {
-		currentDecisionPoint->transitions.push_back(std::make_shared<LLkTransition>(lookaheadSymbol));
+		approximationGrew = followSymbols.size() > entry.symbols.size();
+		entry.symbols = followSymbols.clone();
+	} while (m_followCycleDepth == entry.evaluationDepth && approximationGrew);
+	--m_followEvaluationDepth;
+
+	if (m_followCycleDepth < entry.evaluationDepth) {
+		// relies on an evaluation further up that is yet to finish, so this is not final -- forget it and let it be recomputed later
+		SymbolGroupList ret = entry.symbols;
+		m_followMemo.erase(nonterminal);
+		m_followCycleDepth = std::min(outerCycleDepth, m_followCycleDepth);
+		return ret;
 	}
 
-	return lookaheadSymbols;
+	entry.complete = true;
+	m_followCycleDepth = outerCycleDepth;
+	return entry.symbols.clone();
 }
 
 LLkDecisionPoint LLkBuilder::getDecisionTree(ILLkFirstableCPtr firstable) {
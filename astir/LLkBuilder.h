@@ -47,6 +47,15 @@ struct LLkFlyweight {
 	LLkDecisionPoint decisions;
 };
 
+struct LLkFollowMemoEntry {
+	SymbolGroupList symbols;
+	size_t evaluationDepth;
+	bool complete;
+
+	LLkFollowMemoEntry()
+		: evaluationDepth(0), complete(false) { }
+};
+
 struct LLkParserDefinition;
 class LLkBuilder {
 public:
@@ -75,12 +84,22 @@ public:
 	const LLkParserDefinition* contextMachine() const { return m_contextMachine; }
 	LLkFirster& firster() { return m_firster; }
 	const std::map<ILLkNonterminalCPtr, LLkFlyweight>& flyweights() const { return m_flyweights; }
+	void restoreFlyweights(std::map<ILLkNonterminalCPtr, LLkFlyweight>&& flyweights); // in place of visiting the machine, when restoring from the construction cache
 
 private:
 	const LLkParserDefinition* m_contextMachine;
 	std::map<ILLkNonterminalCPtr, LLkFlyweight> m_flyweights;
 	LLkFirster m_firster;
 
+	// FOLLOW memo table -- what may come after a nonterminal, evaluated on the empty prefix and hence keyed by the nonterminal alone
+	std::map<ILLkNonterminalCPtr, LLkFollowMemoEntry> m_followMemo;
+	size_t m_followEvaluationDepth;
+	size_t m_followCycleDepth;
+	static constexpr size_t NO_FOLLOW_CYCLE = (size_t)-1;
+
+	SymbolGroupList follow(ILLkNonterminalCPtr nonterminal);
+	bool followIsApproximate() const { return m_followCycleDepth < m_followEvaluationDepth; }
+
 	SymbolGroupList sequentialLookahead(std::list<ILLkFirstableCPtr>::const_iterator& sequenceIt, const std::list<ILLkFirstableCPtr>::const_iterator& sequenceEnd, const SymbolGroupList& prefix);
 	void registerContextAppearance(ILLkNonterminalCPtr target, ILLkNonterminalCPtr parent, const std::list<ILLkFirstableCPtr>& followedBy);
 	void registerContextAppearance(ILLkNonterminalCPtr target, ILLkNonterminalCPtr parent, std::list<ILLkFirstableCPtr>::const_iterator followedByIt, std::list<ILLkFirstableCPtr>::const_iterator followedByEnd);
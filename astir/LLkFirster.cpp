@@ -5,17 +5,23 @@
 #include "SemanticAnalysisException.h"
 #include "LLkParserDefinition.h"
 
+#include <sstream>
+
 LLkFirster::LLkFirster(const LLkParserDefinition* machine)
 	: m_machine(machine) { }
 
 SymbolGroupList LLkFirster::visit(const CategoryStatement* cs, const SymbolGroupList& prefix) {
+	const MemoKey memoKey = makeMemoKey(cs, prefix);
 	SymbolGroupList ret;
+	if (recall(memoKey, ret)) {
+		return ret;
+	}
 
 	for (const auto& categoryReferencePair : cs->references) {
 		ret += categoryReferencePair.second.statement->first(this, prefix);
 	}
 
-	return ret;
+	return memorize(memoKey, ret);
 }
 
 SymbolGroupList LLkFirster::visit(const RuleStatement* rs, const SymbolGroupList& prefix) {
@@ -23,10 +29,15 @@ SymbolGroupList LLkFirster::visit(const RuleStatement* rs, const SymbolGroupList
 }
 
 SymbolGroupList LLkFirster::visit(const RepetitiveRegex* rr, const SymbolGroupList& prefix) {
+	const MemoKey memoKey = makeMemoKey(rr, prefix);
+	SymbolGroupList ret;
+	if (recall(memoKey, ret)) {
+		return ret;
+	}
+
 	const auto& atom = rr->regex;
 	unsigned long counter = 0;
 
-	SymbolGroupList ret;
 	std::list<std::pair<SymbolGroupList::const_iterator, SymbolGroupList::const_iterator>> currentQueueOfPrefixEnds, nextQueueOfPrefixEnds({ {prefix.cbegin(), prefix.cbegin() } });
 
 	while (!nextQueueOfPrefixEnds.empty() && counter < rr->maxRepetitions) {
@@ -67,7 +78,7 @@ SymbolGroupList LLkFirster::visit(const RepetitiveRegex* rr, const SymbolGroupLi
 		ret.push_back(std::make_shared<EmptySymbolGroup>());
 	}
 
-	return ret;
+	return memorize(memoKey, ret);
 }
 
 SymbolGroupList LLkFirster::visit(const DisjunctiveRegex* dr, const SymbolGroupList& prefix) {
@@ -81,9 +92,13 @@ SymbolGroupList LLkFirster::visit(const DisjunctiveRegex* dr, const SymbolGroupL
 }
 
 SymbolGroupList LLkFirster::visit(const ConjunctiveRegex* cr, const SymbolGroupList& prefix) {
-	auto conjunctionIt = cr->conjunction.cbegin();
-
+	const MemoKey memoKey = makeMemoKey(cr, prefix);
 	SymbolGroupList ret;
+	if (recall(memoKey, ret)) {
+		return ret;
+	}
+
+	auto conjunctionIt = cr->conjunction.cbegin();
 	std::list<std::pair<SymbolGroupList::const_iterator, SymbolGroupList::const_iterator>> currentQueueOfPrefixEnds, nextQueueOfPrefixEnds({ {prefix.cbegin(), prefix.cbegin() } });
 
 	while(!nextQueueOfPrefixEnds.empty() && conjunctionIt != cr->conjunction.cend()) {
@@ -121,7 +136,7 @@ SymbolGroupList LLkFirster::visit(const ConjunctiveRegex* cr, const SymbolGroupL
 		ret.push_back(std::make_shared<EmptySymbolGroup>());
 	}
 
-	return ret;
+	return memorize(memoKey, ret);
 }
 
 SymbolGroupList LLkFirster::visit(const EmptyRegex* er, const SymbolGroupList& prefix) {
@@ -134,11 +149,18 @@ SymbolGroupList LLkFirster::visit(const EmptyRegex* er, const SymbolGroupList& p
 
 SymbolGroupList LLkFirster::visit(const ReferenceRegex* rr, const SymbolGroupList& prefix) {
 	if (rr->referenceStatementMachine == this->m_machine) {
-		return rr->referenceStatement->first(this, prefix);
+		const MemoKey memoKey = makeMemoKey(rr, prefix);
+		SymbolGroupList ret;
+		if (recall(memoKey, ret)) {
+			return ret;
+		}
+
+		ret = rr->referenceStatement->first(this, prefix);
+		return memorize(memoKey, ret);
 	} else {
 		if (prefix.empty()) {
 			auto statementAsTypeForming = dynamic_cast<const TypeFormingStatement*>(rr->referenceStatement); // if it does not originate from this machine then it must be type-forming as it is a root!
-			return SymbolGroupList({ std::make_shared<StatementSymbolGroup>(statementAsTypeForming, rr->referenceStatementMachine) });
+			return SymbolGroupList({ std::make_shared<StatementSymbolGroup>(statementAsTypeForming, rr->referenceStatementMachine, &m_machine->categoryClosure()) });
 		} else if (prefix.size() == 1) {
 			return SymbolGroupList({ std::make_shared<EmptySymbolGroup>() });
 		} else {
@@ -190,3 +212,43 @@ SymbolGroupList LLkFirster::visit(const ArbitrarySymbolRegex* asr, const SymbolG
 		return SymbolGroupList();
 	}
 }
+
+LLkFirster::MemoKey LLkFirster::makeMemoKey(ILLkFirstableCPtr firstable, const SymbolGroupList& prefix) const {
+	// the prefix is canonicalized by value rather than by identity -- the builder keeps creating fresh (but equal) symbol groups
+	std::stringstream ss;
+	for (const auto& sgPtr : prefix) {
+		const SymbolGroup* rawPtr = sgPtr.get();
+		if (auto bytePtr = dynamic_cast<const ByteSymbolGroup*>(rawPtr)) {
+			ss << 'b' << (unsigned int)bytePtr->rangeStart << '-' << (unsigned int)bytePtr->rangeEnd << ';';
+		} else if (auto literalPtr = dynamic_cast<const LiteralSymbolGroup*>(rawPtr)) {
+			if (literalPtr->literal.length() == 1) {
+				// a single-character literal is equal to the corresponding single-byte range
+				ss << 'b' << (unsigned int)(CharType)literalPtr->literal[0] << '-' << (unsigned int)(CharType)literalPtr->literal[0] << ';';
+			} else {
+				ss << 'l' << literalPtr->literal.length() << ':' << literalPtr->literal << ';';
+			}
+		} else if (auto statementPtr = dynamic_cast<const StatementSymbolGroup*>(rawPtr)) {
+			ss << 's' << (const void*)statementPtr->statement << ';';
+		} else {
+			ss << 'e' << ';';
+		}
+	}
+
+	return MemoKey(firstable, ss.str());
+}
+
+bool LLkFirster::recall(const MemoKey& key, SymbolGroupList& result) const {
+	auto fit = m_memo.find(key);
+	if (fit == m_memo.cend()) {
+		return false;
+	}
+
+	// hand out copies only, the callers are free to disjoin (i.e. modify) the symbol groups they receive
+	result = fit->second.clone();
+	return true;
+}
+
+const SymbolGroupList& LLkFirster::memorize(const MemoKey& key, const SymbolGroupList& result) {
+	m_memo[key] = result.clone();
+	return result;
+}
@@ -6,6 +6,9 @@
 #include "MachineStatement.h"
 #include "Regex.h"
 
+#include <map>
+#include <string>
+
 struct LLkParserDefinition;
 class LLkFirster {
 public:
@@ -27,5 +30,13 @@ public:
 
 private:
 	const LLkParserDefinition* m_machine;
+
+	// FIRST_k memo table keyed by the firstable entity and the canonicalized prefix
+	using MemoKey = std::pair<ILLkFirstableCPtr, std::string>;
+	std::map<MemoKey, SymbolGroupList> m_memo;
+
+	MemoKey makeMemoKey(ILLkFirstableCPtr firstable, const SymbolGroupList& prefix) const;
+	bool recall(const MemoKey& key, SymbolGroupList& result) const;
+	const SymbolGroupList& memorize(const MemoKey& key, const SymbolGroupList& result);
 };
 
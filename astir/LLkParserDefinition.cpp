@@ -1,12 +1,14 @@
 #include "LLkParserDefinition.h"
 #include "GenerationVisitor.h"
+#include "ConstructionSerializer.h"
 
 LLkParserDefinition::LLkParserDefinition(unsigned long k)
 	: MachineDefinition({
 				{ MachineFlag::ProductionsTerminalByDefault, MachineDefinitionAttribute(false) },
 				{ MachineFlag::ProductionsRootByDefault, MachineDefinitionAttribute(false) },
 				{ MachineFlag::CategoriesRootByDefault, MachineDefinitionAttribute(false) },
-				{ MachineFlag::AmbiguityResolvedByPrecedence, MachineDefinitionAttribute(false) }
+				{ MachineFlag::AmbiguityResolvedByPrecedence, MachineDefinitionAttribute(false) },
+				{ MachineFlag::KeywordsHashed, MachineDefinitionAttribute(false) }
 	}), m_builder(std::make_unique<LLkBuilder>(this)), m_k(k) { }
 
 void LLkParserDefinition::initialize() {
@@ -15,7 +17,11 @@ void LLkParserDefinition::initialize() {
 	}
 
 	this->MachineDefinition::initialize();
+	if (isUpToDate() || restoreCachedConstruction()) {
+		return;
+	}
 
+	const auto constructionStart = std::chrono::steady_clock::now();
 	for (const auto& statementPair : statements) {
 		auto statementAsLLkBuilding = dynamic_cast<ILLkBuildingCPtr>(statementPair.second.get());
 		statementAsLLkBuilding->accept(m_builder.get());
@@ -23,8 +29,19 @@ void LLkParserDefinition::initialize() {
 
 	auto roots = this->getRoots();
 	m_builder->visitRootDisjunction(roots);
+	recordConstruction(constructionStart);
 }
 
 void LLkParserDefinition::accept(GenerationVisitor* visitor) const {
 	visitor->visit(this);
 }
+
+
+bool LLkParserDefinition::storeConstruction(ConstructionWriter& writer) const {
+	// the flyweights are keyed by grammar elements, which can only be stored if every one of them can be told by its index
+	return writer.writeFlyweights(m_builder->flyweights(), LLkFirstableIndex(*this));
+}
+
+void LLkParserDefinition::restoreConstruction(ConstructionReader& reader) {
+	m_builder->restoreFlyweights(reader.readFlyweights(LLkFirstableIndex(*this)));
+}
\ No newline at end of file
@@ -14,9 +14,12 @@ struct LLkParserDefinition : public MachineDefinition {
 	void initialize() override;
 
 	void accept(GenerationVisitor* visitor) const override;
+	bool storeConstruction(ConstructionWriter& writer) const override;
 
 	LLkBuilder& builder() const { return *m_builder; }
 	unsigned long k() const { return m_k; }
+protected:
+	void restoreConstruction(ConstructionReader& reader) override;
 private:
 	unsigned long m_k;
 	std::unique_ptr<LLkBuilder> m_builder;
@@ -44,6 +44,7 @@ private:
 
 	const std::map<std::string, TokenType> m_keywordMap = std::map<std::string, TokenType>({
 		std::pair<std::string, TokenType>("uses", TokenType::KW_USES),
+		std::pair<std::string, TokenType>("sync", TokenType::KW_SYNC),
 
 		std::pair<std::string, TokenType>("on", TokenType::KW_ON),
 		std::pair<std::string, TokenType>("with", TokenType::KW_WITH),
@@ -61,6 +62,8 @@ private:
 		std::pair<std::string, TokenType>("categories_nonroot_by_default", TokenType::KW_CATEGORIES_NONROOT_BY_DEFAULT),
 		std::pair<std::string, TokenType>("ambiguity_disallowed", TokenType::KW_AMBIGUITY_DISALLOWED),
 		std::pair<std::string, TokenType>("ambiguity_resolved_by_precedence", TokenType::KW_AMBIGUITY_RESOLVED_BY_PRECEDENCE),
+		std::pair<std::string, TokenType>("keywords_hashed", TokenType::KW_KEYWORDS_HASHED),
+		std::pair<std::string, TokenType>("keywords_in_automaton", TokenType::KW_KEYWORDS_IN_AUTOMATON),
 		
 		std::pair<std::string, TokenType>("ignored", TokenType::KW_IGNORED),
 		std::pair<std::string, TokenType>("root", TokenType::KW_ROOT),
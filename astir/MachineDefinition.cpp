@@ -1,6 +1,8 @@
 #include "MachineDefinition.h"
 
 #include "SemanticAnalysisException.h"
+#include "ConstructionCacheException.h"
+#include "ConstructionSerializer.h"
 
 #include <algorithm>
 
@@ -37,6 +39,21 @@ void MachineDefinition::initialize() {
 		usedPair.second->initialize();
 	}
 
+	if (!synchronizingTerminals.empty() && !on.second) {
+		throw SemanticAnalysisException("The machine '" + name + "' lists terminals to synchronize at in the `sync` clause but is not `on` any other machine -- the terminals have to be roots of its input machine", *this);
+	}
+	for (auto& synchronizingPair : synchronizingTerminals) {
+		for (const auto& terminalRoot : on.second->getTerminalRoots()) {
+			if (terminalRoot->name == synchronizingPair.first) {
+				synchronizingPair.second = terminalRoot;
+			}
+		}
+
+		if (!synchronizingPair.second) {
+			throw SemanticAnalysisException("The terminal '" + synchronizingPair.first + "' referenced in the `sync` clause of '" + name + "' is not a terminal root of its input machine '" + on.first + "'", *this);
+		}
+	}
+
 	for (const auto& statementPair : statements) {
 		const auto& statementPtr = statementPair.second;
 
@@ -72,14 +89,8 @@ void MachineDefinition::initialize() {
 		}
 	}
 
-	// check for possible category reference recursion (and obviously whether the referenced category is indeed a category)
-	std::list<std::string> namesEncountered;
-	for (const auto& statementPair : statements) {
-		auto attributedStatementPtr = std::dynamic_pointer_cast<AttributedStatement>(statementPair.second);
-		if (attributedStatementPtr) {
-			completeCategoryReferences(namesEncountered, attributedStatementPtr);
-		}
-	}
+	// with the category hierarchy completed (see completeCategoryHierarchy), its closure can be computed once and for all rather than walked on every symbol group comparison
+	m_categoryClosure.build(*this);
 
 	// at this point we can proceed to initializing the MachineStatements internally (e.g. initializing their fields)
 	for (const auto& statementPair : statements) {
@@ -215,6 +226,17 @@ std::list<std::shared_ptr<ProductionStatement>> MachineDefinition::getTerminalRo
 	return ret;
 }
 
+void MachineDefinition::completeCategoryHierarchy() {
+	// check for possible category reference recursion (and obviously whether the referenced category is indeed a category)
+	std::list<std::string> namesEncountered;
+	for (const auto& statementPair : statements) {
+		auto attributedStatementPtr = std::dynamic_pointer_cast<AttributedStatement>(statementPair.second);
+		if (attributedStatementPtr) {
+			completeCategoryReferences(namesEncountered, attributedStatementPtr);
+		}
+	}
+}
+
 void MachineDefinition::completeCategoryReferences(std::list<std::string> namesEncountered, const std::shared_ptr<AttributedStatement>& attributedStatement, bool mustBeACategory) const {
 	const std::string& nameConsidered = attributedStatement->name;
 	auto fit = std::find(namesEncountered.cbegin(), namesEncountered.cend(), nameConsidered);
@@ -249,7 +271,12 @@ void MachineDefinition::completeCategoryReferences(std::list<std::string> namesE
 
 			categoryReferencePair.second = soNamedCategory;
 		}
-		categoryReferencePair.second->references.emplace(attributedStatement->name, CategoryReference(attributedStatement.get(), false));
+		// the generated code of a machine can only ever produce its own statements, so statements of the machines using it (or on it) do not become a part of its categories
+		auto ownStatementIt = statements.find(attributedStatement->name);
+		auto ownCategoryIt = statements.find(categoryReferencePair.first);
+		if (ownStatementIt != statements.cend() && ownStatementIt->second == attributedStatement && ownCategoryIt != statements.cend() && ownCategoryIt->second == categoryReferencePair.second) {
+			categoryReferencePair.second->references.emplace(attributedStatement->name, CategoryReference(attributedStatement.get(), false));
+		}
 		completeCategoryReferences(namesEncountered, categoryReferencePair.second, true);
 	}
 
@@ -260,7 +287,7 @@ SymbolGroupList MachineDefinition::computeArbitrarySymbolGroupList() const {
 	SymbolGroupList ret;
 	if (on.second) {
 		for (const auto& root : this->getRoots()) {
-			ret.push_back(std::make_shared<StatementSymbolGroup>(root.get(), on.second.get()));
+			ret.push_back(std::make_shared<StatementSymbolGroup>(root.get(), on.second.get(), &m_categoryClosure));
 		}
 	} else {
 		ret.push_back(std::make_shared<ByteSymbolGroup>((CharType)0, (CharType)255));
@@ -268,6 +295,32 @@ SymbolGroupList MachineDefinition::computeArbitrarySymbolGroupList() const {
 	return ret;
 }
 
+bool MachineDefinition::restoreCachedConstruction() {
+	if (m_cachedConstruction.empty()) {
+		return false;
+	}
+
+	bool restored = true;
+	try {
+		ConstructionReader reader(m_cachedConstruction, this);
+		restoreConstruction(reader);
+		if (!reader.atEnd()) {
+			throw ConstructionCacheException("Trailing data after the construction of '" + name + "'");
+		}
+	} catch (const ConstructionCacheException&) {
+		// stale or damaged, never mind, the machine is going to be built the usual way
+		restored = false;
+	}
+
+	m_cachedConstruction.clear();
+	m_isRestoredFromCache = restored;
+	return restored;
+}
+
+void MachineDefinition::restoreConstruction(ConstructionReader&) {
+	throw ConstructionCacheException("The machine '" + name + "' has no construction to be restored");
+}
+
 MachineDefinition::MachineDefinition(const std::map<MachineFlag, MachineDefinitionAttribute>& attributes)
 	: MachineDefinition() {
 	mergeInAttributes(attributes);
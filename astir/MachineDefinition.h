@@ -5,17 +5,21 @@
 #include "IGenerationVisitable.h"
 
 #include "MachineStatement.h"
+#include "CategoryClosure.h"
+#include "Fingerprint.h"
 
 #include <string>
 #include <memory>
 #include <map>
 #include <list>
+#include <chrono>
 
 enum class MachineFlag {
 	ProductionsTerminalByDefault,
 	ProductionsRootByDefault,
 	CategoriesRootByDefault,
-	AmbiguityResolvedByPrecedence
+	AmbiguityResolvedByPrecedence,
+	KeywordsHashed
 };
 
 struct MachineDefinitionAttribute {
@@ -28,13 +32,17 @@ struct MachineDefinitionAttribute {
 		: set(false), value(value) { }
 };
 
+class ConstructionWriter;
+class ConstructionReader;
 struct MachineDefinition : public ISyntacticEntity, public ISemanticEntity, public IGenerationVisitable {
 public:
 	std::string name;
 	std::map<MachineFlag, MachineDefinitionAttribute> attributes;
 	std::map<std::string, std::shared_ptr<MachineDefinition>> uses;
 	std::pair<std::string, std::shared_ptr<MachineDefinition>> on;
+	std::map<std::string, std::shared_ptr<ProductionStatement>> synchronizingTerminals; // of the `on` machine, roots may only start right after those when parsed in parallel
 	std::map<std::string, std::shared_ptr<MachineStatement>> statements;
+	Fingerprint sourceFingerprint; // of the tokens the definition has been parsed from
 
 	void initialize() override;
 
@@ -47,10 +55,26 @@ public:
 	std::list<std::shared_ptr<ProductionStatement>> getTerminalRoots() const;
 	TerminalTypeIndex terminalProductionCount() const { return m_terminalCount; };
 
+	// categories can be referenced (and hence extended) by the statements of other machines, so all of the machines have this done before any of them gets initialized
+	void completeCategoryHierarchy();
 	void completeCategoryReferences(std::list<std::string> namesEncountered, const std::shared_ptr<AttributedStatement>& attributedStatement, bool mustBeACategory = false) const;
 
 	SymbolGroupList computeArbitrarySymbolGroupList() const;
 	bool isOnTerminalInput() const { return m_isOnTerminalInput; }
+	const CategoryClosure& categoryClosure() const { return m_categoryClosure; }
+
+	// up-to-date machines are only semantically processed so as to serve as dependencies, their automata/decision trees are neither built nor generated
+	void markUpToDate() { m_isUpToDate = true; }
+	bool isUpToDate() const { return m_isUpToDate; }
+
+	// what a previous run has built may be handed over by the construction cache, the machine then restores it instead of building anew (see ConstructionCache)
+	void provideCachedConstruction(const std::string& construction) { m_cachedConstruction = construction; }
+	virtual bool storeConstruction(ConstructionWriter&) const { return false; } // false if there is nothing to be stored
+	bool isRestoredFromCache() const { return m_isRestoredFromCache; }
+
+	// when building the automaton/decision trees started and how long it took, zero if they have not been built (see GeneratorStatistics and GeneratorTrace)
+	std::chrono::steady_clock::time_point constructionStart() const { return m_constructionStart; }
+	std::chrono::steady_clock::duration constructionDuration() const { return m_constructionDuration; }
 
 protected:
 	MachineDefinition()
@@ -58,14 +82,25 @@ protected:
 			{ MachineFlag::ProductionsTerminalByDefault, MachineDefinitionAttribute(false) },
 			{ MachineFlag::ProductionsRootByDefault, MachineDefinitionAttribute(false) },
 			{ MachineFlag::CategoriesRootByDefault, MachineDefinitionAttribute(false) },
-			{ MachineFlag::AmbiguityResolvedByPrecedence, MachineDefinitionAttribute(false) }
-			}), m_terminalCount((TerminalTypeIndex)0), m_isOnTerminalInput(false) { }
+			{ MachineFlag::AmbiguityResolvedByPrecedence, MachineDefinitionAttribute(false) },
+			{ MachineFlag::KeywordsHashed, MachineDefinitionAttribute(false) }
+			}), sourceFingerprint(0), m_terminalCount((TerminalTypeIndex)0), m_isOnTerminalInput(false), m_isUpToDate(false), m_isRestoredFromCache(false), m_constructionDuration(std::chrono::steady_clock::duration::zero()) { }
 
 	MachineDefinition(const std::map<MachineFlag, MachineDefinitionAttribute>& attributes);
 
+	bool restoreCachedConstruction(); // false if nothing usable has been provided, the machine has to be built then
+	virtual void restoreConstruction(ConstructionReader& reader);
+	void recordConstruction(std::chrono::steady_clock::time_point start) { m_constructionStart = start; m_constructionDuration = std::chrono::steady_clock::now() - start; }
+
 private:
 	TerminalTypeIndex m_terminalCount;
 
 	void mergeInAttributes(const std::map<MachineFlag, MachineDefinitionAttribute>& attributes);
 	bool m_isOnTerminalInput;
+	CategoryClosure m_categoryClosure;
+	bool m_isUpToDate;
+	std::string m_cachedConstruction;
+	bool m_isRestoredFromCache;
+	std::chrono::steady_clock::time_point m_constructionStart;
+	std::chrono::steady_clock::duration m_constructionDuration;
 };
@@ -0,0 +1,114 @@
+#include "MachineScheduler.h"
+
+#include "MachineDefinition.h"
+
+#include <set>
+#include <algorithm>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <condition_variable>
+
+MachineScheduler::MachineScheduler(const std::map<std::string, std::shared_ptr<MachineDefinition>>& machines, unsigned int jobCount)
+	: m_machines(machines), m_jobCount(jobCount) {
+	if (m_jobCount == 0) {
+		m_jobCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+}
+
+void MachineScheduler::run(const MachineTask& task) const {
+	// build the dependency DAG -- it has already been checked for recursion by SyntacticTree::completeMachineHierarchy
+	std::map<std::string, size_t> unfinishedDependencyCounts;
+	std::map<std::string, std::list<std::string>> dependents;
+	for (const auto& machinePair : m_machines) {
+		std::set<std::string> dependencies;
+		if (machinePair.second->on.second) {
+			dependencies.insert(machinePair.second->on.first);
+		}
+		for (const auto& usesPair : machinePair.second->uses) {
+			dependencies.insert(usesPair.first);
+		}
+
+		unfinishedDependencyCounts[machinePair.first] = dependencies.size();
+		for (const auto& dependency : dependencies) {
+			dependents[dependency].push_back(machinePair.first);
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable readinessChanged;
+	std::deque<std::string> ready;
+	size_t unsettledCount = m_machines.size();
+	std::set<std::string> skipped;
+	std::map<std::string, std::exception_ptr> failures;
+
+	for (const auto& countPair : unfinishedDependencyCounts) {
+		if (countPair.second == 0) {
+			ready.push_back(countPair.first);
+		}
+	}
+
+	std::function<void(const std::string&)> skipDependents = [&](const std::string& machineName) {
+		for (const auto& dependent : dependents[machineName]) {
+			if (skipped.insert(dependent).second) {
+				--unsettledCount;
+				skipDependents(dependent);
+			}
+		}
+	};
+
+	auto work = [&]() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			readinessChanged.wait(lock, [&]() { return !ready.empty() || unsettledCount == 0; });
+			if (ready.empty()) {
+				return;
+			}
+
+			const std::string machineName = ready.front();
+			ready.pop_front();
+			lock.unlock();
+
+			std::exception_ptr failure;
+			try {
+				task(m_machines.at(machineName));
+			} catch (...) {
+				failure = std::current_exception();
+			}
+
+			lock.lock();
+			--unsettledCount;
+			if (failure) {
+				failures.emplace(machineName, failure);
+				skipDependents(machineName);
+			} else {
+				for (const auto& dependent : dependents[machineName]) {
+					if (skipped.find(dependent) == skipped.end() && --unfinishedDependencyCounts[dependent] == 0) {
+						ready.push_back(dependent);
+					}
+				}
+			}
+			readinessChanged.notify_all();
+		}
+	};
+
+	const size_t threadCount = std::min<size_t>(m_jobCount, m_machines.size());
+	if (threadCount <= 1) {
+		work();
+	} else {
+		std::vector<std::thread> workers;
+		for (size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+			workers.emplace_back(work);
+		}
+		for (auto& worker : workers) {
+			worker.join();
+		}
+	}
+
+	if (!failures.empty()) {
+		std::rethrow_exception(failures.begin()->second);
+	}
+}
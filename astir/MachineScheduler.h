@@ -0,0 +1,28 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <functional>
+
+struct MachineDefinition;
+
+/*
+	Runs a task for every machine of a grammar on a pool of worker threads, starting a machine only once all the machines it is `on` or `uses` are done.
+	Should a task fail, the machines depending on it are skipped and, once all the rest has settled, the exception of the alphabetically first failed machine is rethrown
+	-- that way the outcome does not depend on how the work happened to be scheduled.
+*/
+class MachineScheduler {
+public:
+	using MachineTask = std::function<void(const std::shared_ptr<MachineDefinition>&)>;
+
+	MachineScheduler(const std::map<std::string, std::shared_ptr<MachineDefinition>>& machines, unsigned int jobCount);
+
+	void run(const MachineTask& task) const;
+
+	unsigned int jobCount() const { return m_jobCount; }
+
+private:
+	const std::map<std::string, std::shared_ptr<MachineDefinition>>& m_machines;
+	unsigned int m_jobCount;
+};
@@ -196,6 +196,14 @@ void NFA::mergeInContexts(const NFA& rhs) {
     }
 }
 
+size_t NFA::transitionCount() const {
+    size_t ret = 0;
+    for (const auto& state : states) {
+        ret += state.transitions.size();
+    }
+    return ret;
+}
+
 NFA NFA::buildPseudoDFA() const {
     // the idea of the conversion algorithm is quite simple,
     // but what makes the whole conversion rather challenging
@@ -64,6 +64,7 @@ public:
 	State concentrateFinalStates(const NFAActionRegister& actions);
 
 	NFA buildPseudoDFA() const;
+	size_t transitionCount() const;
 
 	static void calculateDisjointTransitions(std::list<Transition>& symbolGroups);
 	static std::list<std::shared_ptr<ByteSymbolGroup>> makeComplementSymbolGroups(const std::list<std::shared_ptr<SymbolGroup>>& symbolGroups);
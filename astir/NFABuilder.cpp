@@ -300,7 +300,7 @@ NFA NFABuilder::visit(const ReferenceRegex* regex) const {
 		NFAActionRegister initial, final;
 		std::tie(initial, final) = computeActionRegisterEntries(regex->actions);
 		auto typeFormingStatement = std::dynamic_pointer_cast<TypeFormingStatement>(statement);
-		base.addTransition(0, Transition(newBaseState, std::make_shared<StatementSymbolGroup>(typeFormingStatement.get(), regex->referenceStatementMachine), initial));
+		base.addTransition(0, Transition(newBaseState, std::make_shared<StatementSymbolGroup>(typeFormingStatement.get(), regex->referenceStatementMachine, &m_contextMachine.categoryClosure()), initial));
 		base.addFinalActions(final);
 	}
 
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstddef>
+
+// the peak resident memory of the process so far, in bytes (0 should the platform not tell)
+// shared by the `--stats` report of the generator and the benchmark drivers, it needs psapi on Windows
+size_t peakResidentBytes();
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+	Accounts for the memory taken by the productions, terminals, raw terminals and locations the machines create, to tell which types of the grammar (and of the stream) drive the memory use.
+	All of them are created by makeAccounted, which is no more than std::make_shared unless the generated code is compiled with ASTIR_ALLOCATION_ACCOUNTING defined;
+	with the macro defined, they are allocated through a CountingAllocator instead, which counts the allocations and the bytes of every type (those of the shared_ptr control block included)
+	into its AllocationAccount. AllocationAccounting::report then lists the types by the bytes allocated for them. Any number of threads may allocate at once.
+*/
+struct AllocationAccount {
+	std::string typeName;
+	std::atomic<size_t> allocations;
+	std::atomic<size_t> bytes;
+	std::atomic<size_t> liveAllocations; // allocated but not freed yet
+	std::atomic<size_t> liveBytes;
+
+	AllocationAccount(const std::string& typeName)
+		: typeName(typeName), allocations(0), bytes(0), liveAllocations(0), liveBytes(0) { }
+};
+
+class AllocationAccounting {
+public:
+	struct Summary {
+		std::string typeName;
+		size_t allocations;
+		size_t bytes;
+		size_t liveAllocations;
+		size_t liveBytes;
+	};
+
+	// the account of every type is opened on its first allocation, and stays open (and in place) for the rest of the process
+	static AllocationAccount& open(const std::string& typeName);
+	template <typename Type>
+	static AllocationAccount& account(const char* typeName) { static AllocationAccount& account = open(typeName); return account; }
+
+	static std::vector<Summary> summarize(); // the types allocated so far, the most bytes first
+	static void report(std::ostream& output);
+	static void reset(); // of the counts of allocations and bytes, the live ones are left as they are
+
+private:
+	static std::mutex& accountsMutex() { static std::mutex mutex; return mutex; }
+	static std::deque<AllocationAccount>& accounts() { static std::deque<AllocationAccount> accounts; return accounts; }
+};
+
+template <typename Type>
+class CountingAllocator {
+public:
+	typedef Type value_type;
+
+	CountingAllocator(AllocationAccount& account)
+		: m_account(&account) { }
+	template <typename OtherType>
+	CountingAllocator(const CountingAllocator<OtherType>& other)
+		: m_account(other.m_account) { }
+
+	// std::allocate_shared rebinds the allocator to its control block, so the bytes counted are those actually allocated
+	Type* allocate(size_t count) {
+		const size_t byteCount = count * sizeof(Type);
+		m_account->allocations.fetch_add(1, std::memory_order_relaxed);
+		m_account->bytes.fetch_add(byteCount, std::memory_order_relaxed);
+		m_account->liveAllocations.fetch_add(1, std::memory_order_relaxed);
+		m_account->liveBytes.fetch_add(byteCount, std::memory_order_relaxed);
+		return std::allocator<Type>().allocate(count);
+	}
+	void deallocate(Type* pointer, size_t count) {
+		m_account->liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+		m_account->liveBytes.fetch_sub(count * sizeof(Type), std::memory_order_relaxed);
+		std::allocator<Type>().deallocate(pointer, count);
+	}
+
+	template <typename OtherType>
+	bool operator==(const CountingAllocator<OtherType>& other) const { return m_account == other.m_account; }
+	template <typename OtherType>
+	bool operator!=(const CountingAllocator<OtherType>& other) const { return m_account != other.m_account; }
+
+private:
+	template <typename OtherType>
+	friend class CountingAllocator;
+
+	AllocationAccount* m_account;
+};
+
+template <typename Type, typename... Arguments>
+inline std::shared_ptr<Type> makeAccounted(const char* typeName, Arguments&&... arguments) {
+#ifdef ASTIR_ALLOCATION_ACCOUNTING
+	return std::allocate_shared<Type>(CountingAllocator<Type>(AllocationAccounting::account<Type>(typeName)), std::forward<Arguments>(arguments)...);
+#else
+	(void)typeName;
+	return std::make_shared<Type>(std::forward<Arguments>(arguments)...);
+#endif
+}
+
+inline AllocationAccount& AllocationAccounting::open(const std::string& typeName) {
+	std::lock_guard<std::mutex> lock(accountsMutex());
+	return accounts().emplace_back(typeName);
+}
+
+inline std::vector<AllocationAccounting::Summary> AllocationAccounting::summarize() {
+	std::vector<Summary> ret;
+	{
+		std::lock_guard<std::mutex> lock(accountsMutex());
+		for (const auto& account : accounts()) {
+			ret.push_back({ account.typeName, account.allocations.load(), account.bytes.load(), account.liveAllocations.load(), account.liveBytes.load() });
+		}
+	}
+	std::stable_sort(ret.begin(), ret.end(), [](const Summary& lhs, const Summary& rhs) { return lhs.bytes > rhs.bytes; });
+	return ret;
+}
+
+inline void AllocationAccounting::report(std::ostream& output) {
+	const auto summaries = summarize();
+	size_t totalBytes = 0;
+	size_t nameWidth = 4;
+	for (const auto& summary : summaries) {
+		totalBytes += summary.bytes;
+		nameWidth = std::max(nameWidth, summary.typeName.size());
+	}
+
+	const auto flags = output.flags();
+	const auto precision = output.precision();
+	output << std::left << std::setw(nameWidth) << "type" << std::right
+		<< std::setw(14) << "allocations" << std::setw(16) << "bytes" << std::setw(10) << "share" << std::setw(12) << "bytes/each" << std::setw(14) << "live" << std::setw(16) << "live bytes" << std::endl;
+	output << std::fixed;
+	for (const auto& summary : summaries) {
+		const double share = totalBytes > 0 ? 100.0 * summary.bytes / totalBytes : 0.0;
+		output << std::left << std::setw(nameWidth) << summary.typeName << std::right
+			<< std::setw(14) << summary.allocations << std::setw(16) << summary.bytes
+			<< std::setprecision(1) << std::setw(9) << share << '%'
+			<< std::setw(12) << (summary.allocations > 0 ? summary.bytes / summary.allocations : 0)
+			<< std::setw(14) << summary.liveAllocations << std::setw(16) << summary.liveBytes << std::endl;
+	}
+	output.flags(flags);
+	output.precision(precision);
+}
+
+inline void AllocationAccounting::reset() {
+	std::lock_guard<std::mutex> lock(accountsMutex());
+	for (auto& account : accounts()) {
+		account.allocations = 0;
+		account.bytes = 0;
+	}
+}
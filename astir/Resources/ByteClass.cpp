@@ -0,0 +1,212 @@
+#include "ByteClass.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BYTECLASS_X64
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BYTECLASS_SSSE3_TARGET
+#define BYTECLASS_AVX2_TARGET
+#else
+#define BYTECLASS_SSSE3_TARGET __attribute__((target("ssse3")))
+#define BYTECLASS_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#ifdef BYTECLASS_X64
+namespace {
+	struct ProcessorSupport {
+		bool ssse3;
+		bool avx2;
+
+		ProcessorSupport() {
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			const int highestLeaf = info[0];
+			__cpuid(info, 1);
+			ssse3 = (info[2] & (1 << 9)) != 0;
+			// the OS has to preserve the ymm registers too
+			avx2 = false;
+			if (highestLeaf >= 7 && (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6) {
+				__cpuidex(info, 7, 0);
+				avx2 = (info[1] & (1 << 5)) != 0;
+			}
+#else
+			ssse3 = __builtin_cpu_supports("ssse3");
+			avx2 = __builtin_cpu_supports("avx2");
+#endif
+		}
+	};
+
+	const ProcessorSupport processorSupport;
+
+	unsigned countTrailingZeros(unsigned mask) {
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (unsigned)index;
+#else
+		return (unsigned)__builtin_ctz(mask);
+#endif
+	}
+
+	// the bit of the high nibble of a byte in the tables of ByteClass
+	alignas(16) const unsigned char lowerHighNibbleBits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 0, 0, 0, 0, 0, 0, 0, 0 };
+	alignas(16) const unsigned char upperHighNibbleBits[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 16, 32, 64, 128 };
+}
+#endif
+
+ByteClass::ByteClass(std::initializer_list<unsigned char> members)
+	: m_table(), m_scanning(Scanning::LookingUpNibbles), m_comparedBytes(), m_lowerHighNibbles(), m_upperHighNibbles() {
+	size_t memberCount = 0;
+	for (unsigned char member : members) {
+		if (!m_table[member]) {
+			m_table[member] = true;
+			++memberCount;
+		}
+	}
+
+	if (memberCount > 0 && memberCount <= MAX_COMPARED_BYTES) {
+		m_scanning = Scanning::ComparingMembers;
+	} else if (memberCount < 256 && 256 - memberCount <= MAX_COMPARED_BYTES) {
+		m_scanning = Scanning::ComparingNonMembers;
+	}
+
+	size_t comparedCount = 0;
+	for (size_t byte = 0; byte < 256; ++byte) {
+		if (m_table[byte]) {
+			if (byte >> 4 < 8) {
+				m_lowerHighNibbles[byte & 0xF] |= (unsigned char)(1 << (byte >> 4));
+			} else {
+				m_upperHighNibbles[byte & 0xF] |= (unsigned char)(1 << ((byte >> 4) - 8));
+			}
+		}
+
+		if (comparedCount < MAX_COMPARED_BYTES && m_table[byte] == (m_scanning == Scanning::ComparingMembers)) {
+			m_comparedBytes[comparedCount++] = (unsigned char)byte;
+		}
+	}
+
+	// the unused comparison slots repeat the first compared byte so that they never match anything else
+	for (size_t slot = comparedCount; slot < MAX_COMPARED_BYTES && comparedCount > 0; ++slot) {
+		m_comparedBytes[slot] = m_comparedBytes[0];
+	}
+}
+
+size_t ByteClass::span(const char* begin, const char* end) const {
+	const char* it = begin;
+#ifdef BYTECLASS_X64
+	if (processorSupport.avx2) {
+		it = spanAvx2(it, end);
+	} else if (m_scanning != Scanning::LookingUpNibbles) {
+		it = spanSse2(it, end);
+	} else if (processorSupport.ssse3) {
+		it = spanSsse3(it, end);
+	}
+#endif
+
+	// whatever is left over
+	while (it < end && m_table[(unsigned char)*it]) {
+		++it;
+	}
+	return it - begin;
+}
+
+#ifdef BYTECLASS_X64
+const char* ByteClass::spanSse2(const char* it, const char* end) const {
+	const __m128i first = _mm_set1_epi8((char)m_comparedBytes[0]);
+	const __m128i second = _mm_set1_epi8((char)m_comparedBytes[1]);
+	const __m128i third = _mm_set1_epi8((char)m_comparedBytes[2]);
+	const __m128i fourth = _mm_set1_epi8((char)m_comparedBytes[3]);
+	const unsigned flip = m_scanning == Scanning::ComparingMembers ? 0xFFFFu : 0u;
+
+	while (end - it >= 16) {
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+		const __m128i matches = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(block, first), _mm_cmpeq_epi8(block, second)),
+			_mm_or_si128(_mm_cmpeq_epi8(block, third), _mm_cmpeq_epi8(block, fourth)));
+		const unsigned nonMembers = (unsigned)_mm_movemask_epi8(matches) ^ flip;
+		if (nonMembers != 0) {
+			return it + countTrailingZeros(nonMembers);
+		}
+		it += 16;
+	}
+
+	return it;
+}
+
+BYTECLASS_SSSE3_TARGET const char* ByteClass::spanSsse3(const char* it, const char* end) const {
+	const __m128i lowerHighNibbles = _mm_load_si128(reinterpret_cast<const __m128i*>(m_lowerHighNibbles));
+	const __m128i upperHighNibbles = _mm_load_si128(reinterpret_cast<const __m128i*>(m_upperHighNibbles));
+	const __m128i lowerBits = _mm_load_si128(reinterpret_cast<const __m128i*>(lowerHighNibbleBits));
+	const __m128i upperBits = _mm_load_si128(reinterpret_cast<const __m128i*>(upperHighNibbleBits));
+	const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+	const __m128i zero = _mm_setzero_si128();
+
+	while (end - it >= 16) {
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+		const __m128i lowNibbles = _mm_and_si128(block, nibbleMask);
+		const __m128i highNibbles = _mm_and_si128(_mm_srli_epi16(block, 4), nibbleMask);
+		const __m128i memberBits = _mm_or_si128(
+			_mm_and_si128(_mm_shuffle_epi8(lowerHighNibbles, lowNibbles), _mm_shuffle_epi8(lowerBits, highNibbles)),
+			_mm_and_si128(_mm_shuffle_epi8(upperHighNibbles, lowNibbles), _mm_shuffle_epi8(upperBits, highNibbles)));
+		const unsigned nonMembers = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(memberBits, zero));
+		if (nonMembers != 0) {
+			return it + countTrailingZeros(nonMembers);
+		}
+		it += 16;
+	}
+
+	return it;
+}
+
+BYTECLASS_AVX2_TARGET const char* ByteClass::spanAvx2(const char* it, const char* end) const {
+	if (m_scanning == Scanning::LookingUpNibbles) {
+		// the shuffles work within the 128-bit lanes, so the tables are repeated in both
+		const __m256i lowerHighNibbles = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(m_lowerHighNibbles)));
+		const __m256i upperHighNibbles = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(m_upperHighNibbles)));
+		const __m256i lowerBits = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(lowerHighNibbleBits)));
+		const __m256i upperBits = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(upperHighNibbleBits)));
+		const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+		const __m256i zero = _mm256_setzero_si256();
+
+		while (end - it >= 32) {
+			const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+			const __m256i lowNibbles = _mm256_and_si256(block, nibbleMask);
+			const __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi16(block, 4), nibbleMask);
+			const __m256i memberBits = _mm256_or_si256(
+				_mm256_and_si256(_mm256_shuffle_epi8(lowerHighNibbles, lowNibbles), _mm256_shuffle_epi8(lowerBits, highNibbles)),
+				_mm256_and_si256(_mm256_shuffle_epi8(upperHighNibbles, lowNibbles), _mm256_shuffle_epi8(upperBits, highNibbles)));
+			const unsigned nonMembers = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(memberBits, zero));
+			if (nonMembers != 0) {
+				return it + countTrailingZeros(nonMembers);
+			}
+			it += 32;
+		}
+
+		return spanSsse3(it, end);
+	}
+
+	const __m256i first = _mm256_set1_epi8((char)m_comparedBytes[0]);
+	const __m256i second = _mm256_set1_epi8((char)m_comparedBytes[1]);
+	const __m256i third = _mm256_set1_epi8((char)m_comparedBytes[2]);
+	const __m256i fourth = _mm256_set1_epi8((char)m_comparedBytes[3]);
+	const unsigned flip = m_scanning == Scanning::ComparingMembers ? 0xFFFFFFFFu : 0u;
+
+	while (end - it >= 32) {
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+		const __m256i matches = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, first), _mm256_cmpeq_epi8(block, second)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, third), _mm256_cmpeq_epi8(block, fourth)));
+		const unsigned nonMembers = (unsigned)_mm256_movemask_epi8(matches) ^ flip;
+		if (nonMembers != 0) {
+			return it + countTrailingZeros(nonMembers);
+		}
+		it += 32;
+	}
+
+	// the tail shorter than 32 bytes may still be worth a 16-byte step
+	return spanSse2(it, end);
+}
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+
+/*
+	A set of bytes that can measure how long a run of its members is, for the raw streams to get through such runs in one go.
+	Classes of a few members or of a few non-members (exit bytes) are scanned by comparing against those directly, any other class by a lookup in the nibble tables.
+	The scanning goes 32 bytes at a time with AVX2, or 16 bytes at a time with SSE2 (SSSE3 for the nibble tables), whichever the processor supports (decided at runtime); platforms other than x86-64 go byte by byte.
+*/
+class ByteClass {
+public:
+	ByteClass(std::initializer_list<unsigned char> members);
+
+	bool contains(unsigned char byte) const { return m_table[byte]; }
+	size_t span(const char* begin, const char* end) const; // the length of the longest prefix of [begin, end) made of members only
+
+private:
+	static constexpr size_t MAX_COMPARED_BYTES = 4;
+
+	enum class Scanning {
+		ComparingMembers,
+		ComparingNonMembers,
+		LookingUpNibbles
+	};
+
+	bool m_table[256];
+	Scanning m_scanning;
+	unsigned char m_comparedBytes[MAX_COMPARED_BYTES];
+	// for the low nibble of a byte, the bits of the high nibbles it is a member with, 0-7 in the first table and 8-15 in the second one
+	alignas(16) unsigned char m_lowerHighNibbles[16];
+	alignas(16) unsigned char m_upperHighNibbles[16];
+
+	const char* spanSse2(const char* it, const char* end) const;
+	const char* spanSsse3(const char* it, const char* end) const;
+	const char* spanAvx2(const char* it, const char* end) const;
+};
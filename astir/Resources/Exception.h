@@ -1,13 +1,14 @@
 #pragma once
 
+#include <stdexcept>
 #include <string>
-#include <exception>
 
-class Exception : public std::exception {
+class Exception : public std::runtime_error {
 public:
-	Exception() = default;
+	Exception()
+		: std::runtime_error("") { }
 	Exception(const std::string& message)
-		: std::exception(message.c_str()) { }
+		: std::runtime_error(message) { }
 
 	virtual ~Exception() = default;
 };
\ No newline at end of file
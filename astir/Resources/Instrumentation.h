@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+#ifdef ASTIR_INSTRUMENTATION
+#include "TraceEvents.h"
+#endif
+
+/*
+	Counters of the work done by the machines reading a stream, to tell why some inputs take longer than others.
+	They are only kept if the generated code is compiled with ASTIR_INSTRUMENTATION defined; otherwise every ASTIR_INSTRUMENT statement compiles out to nothing,
+	the streams have no counters to keep, and ProductionStream::counters() gives all zeros.
+*/
+struct InstrumentationCounters {
+	size_t branchingPoints = 0; // taken by finite automata in states with more than a single transition on the symbol read
+	size_t rollbacks = 0; // of finite automata back to the end of the longest token accepted, having read past it
+	size_t rescannedProductions = 0; // read again after a rollback or on returning to a branching point (bytes, on raw input)
+	size_t peekCacheHits = 0; // of Machine::peek
+	size_t peekCacheMisses = 0;
+	size_t maxPinDepth = 0;
+	size_t maxBufferedProductions = 0; // the high-water mark of the buffer of the stream
+
+	void reset() { *this = InstrumentationCounters(); }
+};
+
+// ASTIR_TRACE opens a span of the TraceEventLog installed, if any, lasting until the end of the enclosing block (see TraceEvents.h)
+#ifdef ASTIR_INSTRUMENTATION
+#define ASTIR_INSTRUMENT(statement) do { statement; } while (false)
+#define ASTIR_TRACE(name, category) TraceEventLog::Span astirTraceSpan(name, category)
+#else
+#define ASTIR_INSTRUMENT(statement) do { } while (false)
+#define ASTIR_TRACE(name, category) do { } while (false)
+#endif
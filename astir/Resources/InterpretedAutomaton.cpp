@@ -0,0 +1,426 @@
+#include "InterpretedAutomaton.h"
+
+#include <fstream>
+#include <algorithm>
+
+namespace {
+	// the action types as in astir's NFAActionType
+	enum class OperationType : unsigned char {
+		Flag = 1,
+		Unflag = 2,
+
+		Capture = 3,
+		Empty = 4,
+		Append = 5,
+		Prepend = 6,
+
+		Set = 7,
+		Unset = 8,
+		Push = 9,
+		Pop = 10,
+		Clear = 11,
+
+		CreateContext = 101,
+		TerminalizeContext = 102,
+		ElevateContext = 103,
+		IgnoreContext = 104,
+		InitiateCapture = 105,
+
+		None = 255
+	};
+
+	const char* const TABLE_MAGIC = "ASTIRT";
+	const uint64_t TABLE_FORMAT_VERSION = 2;
+
+	class TableReader {
+	public:
+		TableReader(std::istream& stream)
+			: m_stream(stream) { }
+
+		unsigned char readByte() {
+			char byte;
+			if (!m_stream.get(byte)) {
+				throw InterpretedAutomatonException("Unexpected end of the automaton table");
+			}
+			return (unsigned char)byte;
+		}
+
+		uint64_t readSize() {
+			uint64_t size = 0;
+			for (int byteIndex = 0; byteIndex < 8; ++byteIndex) {
+				size |= (uint64_t)readByte() << (8 * byteIndex);
+			}
+			return size;
+		}
+
+		std::string readString() {
+			uint64_t size = readSize();
+			std::string ret;
+			for (uint64_t charIndex = 0; charIndex < size; ++charIndex) {
+				ret.push_back((char)readByte());
+			}
+			return ret;
+		}
+
+	private:
+		std::istream& m_stream;
+	};
+}
+
+std::shared_ptr<const InterpretedAutomatonTable> InterpretedAutomatonTable::load(std::istream& tableStream) {
+	TableReader reader(tableStream);
+	for (const char* magicIt = TABLE_MAGIC; *magicIt != '\0'; ++magicIt) {
+		if (reader.readByte() != (unsigned char)*magicIt) {
+			throw InterpretedAutomatonException("Not an automaton table");
+		}
+	}
+	if (reader.readSize() != TABLE_FORMAT_VERSION) {
+		throw InterpretedAutomatonException("Unsupported automaton table version");
+	}
+
+	std::shared_ptr<InterpretedAutomatonTable> table(new InterpretedAutomatonTable());
+	table->m_machineName = reader.readString();
+	table->internContext("m_token");
+
+	uint64_t typeCount = reader.readSize();
+	for (uint64_t typeIndex = 0; typeIndex < typeCount; ++typeIndex) {
+		table->m_typeNames.push_back(reader.readString());
+	}
+
+	uint64_t stateCount = reader.readSize();
+	table->m_finality.resize(stateCount);
+	table->m_statePrograms.resize(stateCount);
+	std::vector<std::vector<std::pair<State, ProgramId>>> cells(stateCount * SYMBOL_COUNT);
+	for (State state = 0; state < stateCount; ++state) {
+		table->m_finality[state] = reader.readByte();
+		table->m_statePrograms[state] = (ProgramId)reader.readSize();
+
+		uint64_t cellCount = reader.readSize();
+		for (uint64_t cellIndex = 0; cellIndex < cellCount; ++cellIndex) {
+			unsigned char symbol = reader.readByte();
+			uint64_t targetCount = reader.readSize();
+			for (uint64_t targetIndex = 0; targetIndex < targetCount; ++targetIndex) {
+				State target = (State)reader.readSize();
+				ProgramId programId = (ProgramId)reader.readSize();
+				if (target >= stateCount) {
+					throw InterpretedAutomatonException("Transition to a nonexistent state in the automaton table");
+				}
+				cells[state * SYMBOL_COUNT + symbol].emplace_back(target, programId);
+			}
+		}
+	}
+
+	table->m_cellOffsets.reserve(cells.size() + 1);
+	for (const auto& cell : cells) {
+		table->m_cellOffsets.push_back(table->m_cellTargets.size());
+		for (const auto& targetProgramPair : cell) {
+			table->m_cellTargets.push_back(targetProgramPair.first);
+			table->m_cellPrograms.push_back(targetProgramPair.second);
+		}
+	}
+	table->m_cellOffsets.push_back(table->m_cellTargets.size());
+
+	uint64_t programCount = reader.readSize();
+	table->m_programs.resize(programCount + 1); // the 0th is the empty one
+	for (uint64_t programIndex = 1; programIndex <= programCount; ++programIndex) {
+		uint64_t operationCount = reader.readSize();
+		for (uint64_t operationIndex = 0; operationIndex < operationCount; ++operationIndex) {
+			Operation operation;
+			operation.type = reader.readByte();
+			std::string contextPath = reader.readString();
+			operation.targetName = reader.readString();
+			std::string payload = reader.readString();
+
+			operation.context = table->internContext(contextPath);
+			operation.subcontext = NO_CONTEXT;
+			operation.subcontextType = 0;
+			switch ((OperationType)operation.type) {
+				case OperationType::CreateContext: {
+					auto typeIt = std::find(table->m_typeNames.cbegin(), table->m_typeNames.cend(), operation.targetName);
+					if (typeIt == table->m_typeNames.cend()) {
+						throw InterpretedAutomatonException("The automaton table creates a context of the unknown type '" + operation.targetName + "'");
+					}
+					operation.subcontextType = typeIt - table->m_typeNames.cbegin();
+				}
+				// fall through
+				case OperationType::TerminalizeContext:
+				case OperationType::ElevateContext:
+				case OperationType::IgnoreContext:
+					operation.subcontext = table->internContext(contextPath + "__" + operation.targetName);
+					break;
+				default:
+					break;
+			}
+			operation.payloadContext = payload.empty() ? NO_CONTEXT : table->internContext(payload);
+
+			table->m_programs[programIndex].push_back(operation);
+		}
+	}
+
+	for (State state = 0; state < stateCount; ++state) {
+		if (table->m_statePrograms[state] > programCount) {
+			throw InterpretedAutomatonException("Reference to a nonexistent action program in the automaton table");
+		}
+	}
+	for (ProgramId programId : table->m_cellPrograms) {
+		if (programId > programCount) {
+			throw InterpretedAutomatonException("Reference to a nonexistent action program in the automaton table");
+		}
+	}
+
+	uint64_t keywordCount = reader.readSize();
+	for (uint64_t keywordIndex = 0; keywordIndex < keywordCount; ++keywordIndex) {
+		size_t identifierType = (size_t)reader.readSize();
+		std::string text = reader.readString();
+		size_t keywordType = (size_t)reader.readSize();
+		if (identifierType >= typeCount || keywordType >= typeCount) {
+			throw InterpretedAutomatonException("Reference to a nonexistent type in the keywords of the automaton table");
+		}
+		table->m_keywords.emplace(std::make_pair(identifierType, text), keywordType);
+	}
+
+	return table;
+}
+
+std::shared_ptr<const InterpretedAutomatonTable> InterpretedAutomatonTable::loadFile(const std::string& fileName) {
+	std::ifstream tableFile(fileName, std::ios::in | std::ios::binary);
+	if (!tableFile) {
+		throw InterpretedAutomatonException("The automaton table '" + fileName + "' could not be opened");
+	}
+
+	return load(tableFile);
+}
+
+bool InterpretedAutomatonTable::findKeyword(size_t identifierType, const std::string& text, size_t& keywordType) const {
+	if (m_keywords.empty()) {
+		return false;
+	}
+
+	auto it = m_keywords.find(std::make_pair(identifierType, text));
+	if (it == m_keywords.cend()) {
+		return false;
+	}
+
+	keywordType = it->second;
+	return true;
+}
+
+size_t InterpretedAutomatonTable::internContext(const std::string& contextName) {
+	auto it = std::find(m_contextNames.cbegin(), m_contextNames.cend(), contextName);
+	if (it != m_contextNames.cend()) {
+		return it - m_contextNames.cbegin();
+	}
+
+	m_contextNames.push_back(contextName);
+	return m_contextNames.size() - 1;
+}
+
+std::shared_ptr<InterpretedTerminal> InterpretedAutomaton::apply(RawStream& rs) {
+	using State = InterpretedAutomatonTable::State;
+	using ProgramId = InterpretedAutomatonTable::ProgramId;
+
+	// the same procedure as the one of the generated automata, only with the action programs in place of the action methods
+	struct BranchingPoint {
+		size_t inputPosition;
+		size_t actionStackPosition;
+		size_t cellBegin;
+		size_t remainingCount; // the remaining targets are taken from the back of the cell
+
+		BranchingPoint(size_t inputPosition, size_t actionStackPosition, size_t cellBegin, size_t remainingCount)
+			: inputPosition(inputPosition), actionStackPosition(actionStackPosition), cellBegin(cellBegin), remainingCount(remainingCount) { }
+	};
+
+	struct ActionPack {
+		ProgramId program;
+		size_t position;
+		std::shared_ptr<Location> location;
+
+		ActionPack(ProgramId program, size_t position, const std::shared_ptr<Location>& location)
+			: program(program), position(position), location(location) { }
+	};
+
+	const InterpretedAutomatonTable& table = *m_table;
+	std::shared_ptr<InterpretedTerminal> tokenToReturn = nullptr;
+
+	rs.pin();
+
+	State lastAcceptingState = (State)(-1);
+	size_t lastAcceptedInputPosition = 0;
+	std::vector<ActionPack> lastAcceptedActionStack;
+	std::vector<BranchingPoint> branchingPoints;
+	std::vector<ActionPack> actionStack;
+
+	if (table.stateProgram(0) != 0) {
+		actionStack.emplace_back(table.stateProgram(0), rs.currentPositionRelativeToLastPin(), rs.lastLocation());
+	}
+
+	while (true) {
+		std::shared_ptr<RawTerminal> currentTerminal;
+		auto currentPosition = rs.currentPositionRelativeToLastPin();
+		auto currentLocation = rs.lastLocation();
+		bool readingOutcome = rs.get(currentTerminal);
+		size_t cellBegin = 0, cellEnd = 0;
+		if (readingOutcome) {
+			cellBegin = table.cellBegin(m_currentState, (unsigned char)currentTerminal->type);
+			cellEnd = table.cellEnd(m_currentState, (unsigned char)currentTerminal->type);
+		}
+
+		size_t cellEntryTaken;
+		if (cellBegin == cellEnd) {
+			if (!branchingPoints.empty()) {
+				BranchingPoint& lastBp = branchingPoints.back();
+				ASTIR_INSTRUMENT(rs.counters().rescannedProductions += rs.currentPositionRelativeToLastPin() - lastBp.inputPosition);
+				currentPosition = lastBp.inputPosition;
+				rs.resetToPositionRelativeToLastPin(lastBp.inputPosition);
+				currentLocation = rs.lastLocation();
+				readingOutcome = rs.get(currentTerminal);
+
+				--lastBp.remainingCount;
+				cellEntryTaken = lastBp.cellBegin + lastBp.remainingCount;
+				actionStack.resize(lastBp.actionStackPosition, ActionPack(0, 0, nullptr));
+
+				if (lastBp.remainingCount == 0) {
+					branchingPoints.pop_back();
+				}
+			} else {
+				if (lastAcceptingState == (State)(-1)) {
+					rs.unpin();
+					break;
+				} else {
+					ASTIR_INSTRUMENT(++rs.counters().rollbacks; rs.counters().rescannedProductions += rs.currentPositionRelativeToLastPin() - lastAcceptedInputPosition);
+					rs.resetToPositionRelativeToLastPin(lastAcceptedInputPosition);
+					std::deque<std::shared_ptr<RawTerminal>> completeInput = rs.bufferSincePin();
+					rs.unpin();
+
+					for (const ActionPack& actionPack : lastAcceptedActionStack) {
+						execute(actionPack.program, actionPack.position, completeInput, actionPack.location);
+					}
+
+					tokenToReturn = m_contexts[0];
+					m_currentState = lastAcceptingState;
+					break;
+				}
+			}
+		} else if (cellEnd - cellBegin == 1) {
+			cellEntryTaken = cellBegin;
+		} else {
+			branchingPoints.emplace_back(currentPosition, actionStack.size(), cellBegin, cellEnd - cellBegin - 1);
+			ASTIR_INSTRUMENT(++rs.counters().branchingPoints);
+			cellEntryTaken = cellEnd - 1;
+		}
+
+		State stateToGoTo = table.cellTarget(cellEntryTaken);
+		if (table.cellProgram(cellEntryTaken) != 0) {
+			actionStack.emplace_back(table.cellProgram(cellEntryTaken), currentPosition, currentLocation);
+		}
+		if (table.stateProgram(stateToGoTo) != 0) {
+			actionStack.emplace_back(table.stateProgram(stateToGoTo), currentPosition, currentLocation);
+		}
+
+		if (table.isFinal(stateToGoTo) && rs.currentPositionRelativeToLastPin() > lastAcceptedInputPosition) {
+			lastAcceptingState = stateToGoTo;
+			lastAcceptedInputPosition = rs.currentPositionRelativeToLastPin();
+			lastAcceptedActionStack = actionStack;
+		}
+
+		m_currentState = stateToGoTo;
+	}
+
+	m_contexts[0] = nullptr;
+	return tokenToReturn;
+}
+
+void InterpretedAutomaton::reset() {
+	m_currentState = 0;
+}
+
+void InterpretedAutomaton::execute(InterpretedAutomatonTable::ProgramId programId, size_t position, const std::deque<std::shared_ptr<RawTerminal>>& input, const std::shared_ptr<Location>& location) {
+	for (const auto& operation : m_table->program(programId)) {
+		const std::shared_ptr<InterpretedTerminal>& context = m_contexts[operation.context];
+		switch ((OperationType)operation.type) {
+			case OperationType::Flag:
+				context->flags.insert(operation.targetName);
+				break;
+			case OperationType::Unflag:
+				context->flags.erase(operation.targetName);
+				break;
+
+			case OperationType::InitiateCapture:
+				m_captureStack.push(position);
+				break;
+			case OperationType::Capture:
+				context->raws[operation.targetName] = capture(position, input);
+				break;
+			case OperationType::Empty:
+				context->raws[operation.targetName].clear();
+				break;
+			case OperationType::Append:
+				context->raws[operation.targetName].append(capture(position, input));
+				break;
+			case OperationType::Prepend:
+				context->raws[operation.targetName].insert(0, capture(position, input));
+				break;
+
+			case OperationType::CreateContext:
+				m_contexts[operation.subcontext] = makeAccounted<InterpretedTerminal>("InterpretedTerminal", operation.subcontextType, location);
+				m_captureStack.push(position);
+				break;
+			case OperationType::TerminalizeContext:
+				m_contexts[operation.subcontext]->raw = capture(position, input);
+				break;
+			case OperationType::ElevateContext: {
+				m_contexts[operation.context] = m_contexts[operation.subcontext];
+				// the token may turn out to be one of the keywords left out of the automaton
+				const std::shared_ptr<InterpretedTerminal>& elevated = m_contexts[operation.context];
+				size_t keywordType;
+				if (operation.context == 0 && elevated && m_table->findKeyword(elevated->type, elevated->raw, keywordType)) {
+					auto keyword = makeAccounted<InterpretedTerminal>("InterpretedTerminal", keywordType, elevated->location());
+					keyword->raw = elevated->raw;
+					m_contexts[operation.context] = keyword;
+				}
+				break;
+			}
+			case OperationType::IgnoreContext:
+				m_contexts[operation.subcontext] = nullptr;
+				break;
+
+			case OperationType::Set:
+			case OperationType::Push: {
+				std::shared_ptr<Production> payload;
+				if (operation.payloadContext == InterpretedAutomatonTable::NO_CONTEXT) {
+					payload = input[position];
+				} else {
+					payload = m_contexts[operation.payloadContext];
+				}
+
+				auto& item = context->items[operation.targetName];
+				if ((OperationType)operation.type == OperationType::Set) {
+					item.clear();
+				}
+				item.push_back(payload);
+				break;
+			}
+			case OperationType::Unset:
+			case OperationType::Clear:
+				context->items[operation.targetName].clear();
+				break;
+			case OperationType::Pop:
+				context->items[operation.targetName].pop_back();
+				break;
+
+			case OperationType::None:
+				break;
+		}
+	}
+}
+
+std::string InterpretedAutomaton::capture(size_t position, const std::deque<std::shared_ptr<RawTerminal>>& input) {
+	auto stackPos = m_captureStack.top();
+	m_captureStack.pop();
+
+	std::string ret;
+	for (auto it = input.cbegin() + stackPos; it < input.cbegin() + position + 1; ++it) {
+		ret += (*it)->raw;
+	}
+	return ret;
+}
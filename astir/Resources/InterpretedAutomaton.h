@@ -0,0 +1,118 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <list>
+#include <memory>
+#include <stack>
+#include <cstdint>
+
+#include "RawStream.h"
+#include "Terminal.h"
+#include "Machine.h"
+
+class InterpretedAutomatonException : public MachineException {
+public:
+	InterpretedAutomatonException() = default;
+	InterpretedAutomatonException(const std::string& message)
+		: MachineException(message) { }
+};
+
+// the type is the index of the type name in the table, terminal types keep the indices they have in the generated code
+class InterpretedTerminal : public Terminal<size_t> {
+public:
+	InterpretedTerminal(size_t type, const std::shared_ptr<Location>& occurenceLocation)
+		: Terminal<size_t>(type, occurenceLocation) { }
+
+	std::set<std::string> flags;
+	std::map<std::string, std::string> raws;
+	std::map<std::string, std::list<std::shared_ptr<Production>>> items; // item fields hold at most one
+};
+
+/*
+	The tables of a finite automaton on raw input as serialized by astir's --interpretable option (the .astirt files), along with the action programs.
+	Immutable once loaded, so a single table can be shared by any number of interpreted automata.
+*/
+class InterpretedAutomatonTable {
+public:
+	using State = size_t;
+	using ProgramId = uint32_t; // 0 for no actions
+
+	struct Operation {
+		unsigned char type; // as in astir's NFAActionType
+		size_t context; // the context operated on
+		size_t subcontext; // the context created, terminalized, elevated or ignored
+		size_t subcontextType;
+		size_t payloadContext; // NO_CONTEXT for the current input terminal
+		std::string targetName;
+	};
+
+	static constexpr size_t NO_CONTEXT = (size_t)-1;
+	static constexpr size_t SYMBOL_COUNT = 256;
+
+	static std::shared_ptr<const InterpretedAutomatonTable> load(std::istream& tableStream);
+	static std::shared_ptr<const InterpretedAutomatonTable> loadFile(const std::string& fileName);
+
+	const std::string& machineName() const { return m_machineName; }
+	const std::string& typeName(size_t type) const { return m_typeNames[type]; }
+	size_t typeCount() const { return m_typeNames.size(); }
+	size_t stateCount() const { return m_finality.size(); }
+	size_t contextCount() const { return m_contextNames.size(); }
+
+	bool isFinal(State state) const { return m_finality[state] != 0; }
+	ProgramId stateProgram(State state) const { return m_statePrograms[state]; }
+	size_t cellBegin(State state, unsigned char symbol) const { return m_cellOffsets[state * SYMBOL_COUNT + symbol]; }
+	size_t cellEnd(State state, unsigned char symbol) const { return m_cellOffsets[state * SYMBOL_COUNT + symbol + 1]; }
+	State cellTarget(size_t cellEntry) const { return m_cellTargets[cellEntry]; }
+	ProgramId cellProgram(size_t cellEntry) const { return m_cellPrograms[cellEntry]; }
+	const std::vector<Operation>& program(ProgramId programId) const { return m_programs[programId]; }
+	// the keywords hashed by the generated automaton, by the type of the identifier they are read as and their text
+	bool findKeyword(size_t identifierType, const std::string& text, size_t& keywordType) const;
+
+private:
+	std::string m_machineName;
+	std::vector<std::string> m_typeNames;
+	std::vector<std::string> m_contextNames; // 0th being m_token
+
+	std::vector<char> m_finality;
+	std::vector<ProgramId> m_statePrograms;
+	// the transition targets of all the states for all the symbols laid out flat, the targets for the (state, symbol) cell lie between cellBegin and cellEnd
+	std::vector<size_t> m_cellOffsets;
+	std::vector<State> m_cellTargets;
+	std::vector<ProgramId> m_cellPrograms;
+	std::vector<std::vector<Operation>> m_programs;
+	std::map<std::pair<size_t, std::string>, size_t> m_keywords;
+
+	InterpretedAutomatonTable() = default;
+	size_t internContext(const std::string& contextName);
+};
+
+/*
+	A finite automaton on raw input that runs the serialized tables directly instead of being generated and compiled, producing InterpretedTerminals.
+	It behaves just like the generated automaton would, including backtracking and the order in which ambiguous transitions are tried.
+*/
+class InterpretedAutomaton : public Machine<RawStream, InterpretedTerminal> {
+public:
+	InterpretedAutomaton(const std::shared_ptr<const InterpretedAutomatonTable>& table)
+		: m_table(table), m_currentState(0), m_contexts(table->contextCount()) { }
+
+	std::shared_ptr<InterpretedTerminal> apply(RawStream& rs) override;
+
+	bool lastApplicationSuccessful() const override { return m_table->isFinal(m_currentState); }
+	void reset() override;
+
+	const InterpretedAutomatonTable& table() const { return *m_table; }
+
+private:
+	std::shared_ptr<const InterpretedAutomatonTable> m_table;
+	InterpretedAutomatonTable::State m_currentState;
+
+	std::stack<size_t> m_captureStack;
+	std::vector<std::shared_ptr<InterpretedTerminal>> m_contexts;
+
+	void execute(InterpretedAutomatonTable::ProgramId programId, size_t position, const std::deque<std::shared_ptr<RawTerminal>>& input, const std::shared_ptr<Location>& location);
+	std::string capture(size_t position, const std::deque<std::shared_ptr<RawTerminal>>& input);
+};
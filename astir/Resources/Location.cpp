@@ -1,4 +1,13 @@
 #include "Location.h"
+#include "AllocationAccounting.h"
+
+#include <algorithm>
+
+void Location::noteAll(const char* begin, const char* end) {
+    for (const char* it = begin; it < end; ++it) {
+        note(*it);
+    }
+}
 
 void TextLocation::note(char c) {
     ++column;
@@ -8,6 +17,21 @@ void TextLocation::note(char c) {
     }
 }
 
+void TextLocation::noteAll(const char* begin, const char* end) {
+    // only the line breaks and whatever follows the last of them matter
+    const char* lastLineBreak = end;
+    while (lastLineBreak > begin && *(lastLineBreak - 1) != '\n') {
+        --lastLineBreak;
+    }
+
+    if (lastLineBreak == begin) {
+        column += (unsigned long)(end - begin);
+    } else {
+        line += (unsigned long)std::count(begin, lastLineBreak, '\n');
+        column = (unsigned long)(end - lastLineBreak);
+    }
+}
+
 void TextLocation::advance() {
     ++column;
 }
@@ -17,7 +41,7 @@ std::string TextLocation::toString() const {
 }
 
 std::shared_ptr<Location> TextLocation::clone() const {
-    return std::make_shared<TextLocation>(*this);
+    return makeAccounted<TextLocation>("TextLocation", *this);
 }
 
 std::string TextFileLocation::toString() const {
@@ -25,7 +49,7 @@ std::string TextFileLocation::toString() const {
 }
 
 std::shared_ptr<Location> TextFileLocation::clone() const {
-    return std::make_shared<TextFileLocation>(*this);
+    return makeAccounted<TextFileLocation>("TextFileLocation", *this);
 }
 
 void InvalidLocation::note(char c) {
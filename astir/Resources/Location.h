@@ -6,6 +6,7 @@
 class Location {
 public:
 	virtual void note(char c) = 0;
+	virtual void noteAll(const char* begin, const char* end); // as if each of the bytes was noted in turn
 	virtual void advance() = 0;
 	virtual std::string toString() const = 0;
 
@@ -38,6 +39,7 @@ public:
 		: line(line), column(column) { }
 
 	void note(char c) override;
+	void noteAll(const char* begin, const char* end) override;
 	void advance() override;
 	std::string toString() const override;
 	std::shared_ptr<Location> clone() const override;
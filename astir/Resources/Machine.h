@@ -1,10 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <list>
 #include <map>
 
 #include "Exception.h"
+#include "Instrumentation.h"
 
 class MachineException : public Exception {
 public:
@@ -100,6 +102,7 @@ inline std::shared_ptr<OutputProductionType> Machine<InputStreamType, OutputProd
 
 template<typename InputStreamType, typename OutputProductionType>
 inline std::list<std::shared_ptr<OutputProductionType>> Machine<InputStreamType, OutputProductionType>::processStream(InputStreamType& rs) {
+	ASTIR_TRACE("processStream", "tokenize");
 	std::list<std::shared_ptr<OutputProductionType>> ret;
 
 	bool wasLastApplicationSuccessful;
@@ -117,6 +120,7 @@ inline std::list<std::shared_ptr<OutputProductionType>> Machine<InputStreamType,
 
 template<typename InputStreamType, typename OutputProductionType>
 inline std::list<std::shared_ptr<OutputProductionType>> Machine<InputStreamType, OutputProductionType>::processStreamWithIgnorance(InputStreamType& rs) {
+	ASTIR_TRACE("processStreamWithIgnorance", "tokenize");
 	std::list<std::shared_ptr<OutputProductionType>> ret;
 
 	bool wasLastApplicationSuccessful;
@@ -136,6 +140,7 @@ inline std::list<std::shared_ptr<OutputProductionType>> Machine<InputStreamType,
 
 template<typename InputStreamType, typename OutputProductionType>
 inline std::list<std::shared_ptr<OutputProductionType>> Machine<InputStreamType, OutputProductionType>::tryProcessStream(InputStreamType& rs) {
+	ASTIR_TRACE("tryProcessStream", "tokenize");
 	std::list<std::shared_ptr<OutputProductionType>> ret;
 
 	bool wasLastApplicationSuccessful;
@@ -157,6 +162,7 @@ inline std::list<std::shared_ptr<OutputProductionType>> Machine<InputStreamType,
 
 template<typename InputStreamType, typename OutputProductionType>
 inline std::list<std::shared_ptr<OutputProductionType>> Machine<InputStreamType, OutputProductionType>::tryProcessStreamWithIgnorance(InputStreamType& rs) {
+	ASTIR_TRACE("tryProcessStreamWithIgnorance", "tokenize");
 	std::list<std::shared_ptr<OutputProductionType>> ret;
 
 	bool wasLastApplicationSuccessful;
@@ -183,9 +189,11 @@ inline std::shared_ptr<OutputProductionType> Machine<InputStreamType, OutputProd
 	size_t targetStartPosition = rs.currentPosition() + ahead;
 	auto fit = m_peekCache.find(targetStartPosition);
 	if (fit != m_peekCache.end()) {
+		ASTIR_INSTRUMENT(++rs.counters().peekCacheHits);
 		cumulativePeekCorrection += fit->second.inputStreamSpan;
 		return fit->second.production;
 	}
+	ASTIR_INSTRUMENT(++rs.counters().peekCacheMisses);
 
 	rs.pin();
 	rs.consume(ahead);
@@ -217,7 +225,7 @@ inline std::shared_ptr<OutputProductionType> Machine<InputStreamType, OutputProd
 		}
 		return ret;
 	} else {
-		throw std::exception("Peeking indices do not correspond to consumption points");
+		throw MachineException("Peeking indices do not correspond to consumption points");
 		return nullptr; // should really throw exception here instead
 	}
 }
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Parser.h"
+
+// only ever used in decltype, to get hold of the input stream type of a parser
+template <typename InputStreamType, typename OutputProductionType>
+InputStreamType* parserInputStream(const Parser<InputStreamType, OutputProductionType>*);
+
+/*
+	Parses a list of input productions (as produced by the machine the parser is on) on several threads at once, producing the very same roots as parseStream would.
+	The list is split into segments, each one starting right after one of the terminals the parser declares in its `sync` clause, and every segment is parsed speculatively by a parser of its own as if a root started there.
+	A speculative parse of a segment is known to be right as soon as the correct parse of the segments before it ends a root exactly where the segment starts, or at any other point where the two parses end a root;
+	should the correct parse never get there (a root spanning several segments), it is simply continued on its own.
+	Only parsers with a `sync` clause can be run this way, as the split needs their isSynchronizing().
+*/
+template <typename ParserType>
+class ParallelParser {
+public:
+	typedef typename std::remove_pointer<decltype(parserInputStream(std::declval<ParserType*>()))>::type InputStream;
+	typedef typename InputStream::StreamElementPtr InputTypePtr;
+	typedef decltype(std::declval<ParserType&>().parse(std::declval<InputStream&>())) OutputProductionPtr;
+
+	ParallelParser(unsigned int threadCount = 0)
+		: m_threadCount(threadCount) {
+		if (m_threadCount == 0) {
+			m_threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+	}
+
+	std::list<OutputProductionPtr> parseStream(const std::list<InputTypePtr>& input);
+	std::list<OutputProductionPtr> parseStreamWithIgnorance(const std::list<InputTypePtr>& input);
+
+	unsigned int threadCount() const { return m_threadCount; }
+
+private:
+	// segments shorter than this (in input productions) are not worth a thread
+	static constexpr size_t MIN_SEGMENT_SIZE = 1024;
+	// how many segments per thread to split the input into, so that the threads that happen to be done early can help out
+	static constexpr size_t SEGMENTS_PER_THREAD = 4;
+
+	typedef typename std::list<InputTypePtr>::const_iterator InputIterator;
+
+	struct Step {
+		OutputProductionPtr production;
+		size_t end; // the index of the input production the root parse stopped at
+	};
+
+	struct Run {
+		size_t start;
+		InputIterator startIterator;
+		std::vector<Step> steps;
+		std::unique_ptr<ParserType> parser;
+		std::unique_ptr<ListProductionStream<typename InputStream::StreamElement>> stream;
+		std::exception_ptr exception; // what stopped the parse, if anything did
+
+		bool finished() const { return exception || (stream && !stream->good()); }
+		size_t lastBoundary() const { return steps.empty() ? start : steps.back().end; }
+		// the index of the step after the given root boundary, or npos if the run does not stop at it
+		size_t stepsAfterBoundary(size_t boundary) const;
+	};
+
+	unsigned int m_threadCount;
+
+	std::list<OutputProductionPtr> parse(const std::list<InputTypePtr>& input, bool withIgnorance);
+	std::vector<std::pair<size_t, InputIterator>> splitIntoSegments(const std::list<InputTypePtr>& input) const;
+	static void speculate(Run& run, const std::list<InputTypePtr>& input, size_t limit);
+	static bool extend(Run& run, const std::list<InputTypePtr>& input);
+};
+
+template <typename ParserType>
+inline std::list<typename ParallelParser<ParserType>::OutputProductionPtr> ParallelParser<ParserType>::parseStream(const std::list<InputTypePtr>& input) {
+	return parse(input, false);
+}
+
+template <typename ParserType>
+inline std::list<typename ParallelParser<ParserType>::OutputProductionPtr> ParallelParser<ParserType>::parseStreamWithIgnorance(const std::list<InputTypePtr>& input) {
+	return parse(input, true);
+}
+
+template <typename ParserType>
+inline size_t ParallelParser<ParserType>::Run::stepsAfterBoundary(size_t boundary) const {
+	if (boundary == start) {
+		return 0;
+	}
+
+	auto stepIt = std::lower_bound(steps.cbegin(), steps.cend(), boundary, [](const Step& step, size_t index) { return step.end < index; });
+	if (stepIt == steps.cend() || stepIt->end != boundary) {
+		return std::string::npos;
+	}
+	return stepIt - steps.cbegin() + 1;
+}
+
+template <typename ParserType>
+inline std::list<typename ParallelParser<ParserType>::OutputProductionPtr> ParallelParser<ParserType>::parse(const std::list<InputTypePtr>& input, bool withIgnorance) {
+	const auto segmentStarts = splitIntoSegments(input);
+
+	std::vector<Run> runs(segmentStarts.size());
+	for (size_t segmentIndex = 0; segmentIndex < segmentStarts.size(); ++segmentIndex) {
+		runs[segmentIndex].start = segmentStarts[segmentIndex].first;
+		runs[segmentIndex].startIterator = segmentStarts[segmentIndex].second;
+	}
+
+	std::atomic<size_t> nextSegmentIndex(0);
+	auto work = [&]() {
+		for (size_t segmentIndex = nextSegmentIndex++; segmentIndex < runs.size(); segmentIndex = nextSegmentIndex++) {
+			const size_t limit = segmentIndex + 1 < runs.size() ? runs[segmentIndex + 1].start : input.size();
+			speculate(runs[segmentIndex], input, limit);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int threadIndex = 1; threadIndex < std::min<size_t>(m_threadCount, runs.size()); ++threadIndex) {
+		threads.emplace_back(work);
+	}
+	work();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	// follow the correct run, switching over to the next one as soon as they meet
+	std::list<OutputProductionPtr> ret;
+	auto take = [&ret, withIgnorance](const Step& step) {
+		if (step.production || !withIgnorance) {
+			ret.push_back(step.production);
+		}
+	};
+	// when the correct run runs out of steps, it either goes on or fails just like parseStream would
+	auto extendCurrent = [&input](Run& run) {
+		if (extend(run, input)) {
+			return true;
+		}
+		if (run.exception) {
+			std::rethrow_exception(run.exception);
+		}
+		return false;
+	};
+
+	Run* current = &runs[0];
+	size_t stepIndex = 0;
+	for (size_t candidateIndex = 1; candidateIndex < runs.size(); ++candidateIndex) {
+		const Run& candidate = runs[candidateIndex];
+		const size_t boundaryReached = stepIndex == 0 ? current->start : current->steps[stepIndex - 1].end;
+		size_t candidateStepIndex = candidate.stepsAfterBoundary(boundaryReached);
+		if (candidateStepIndex != std::string::npos) {
+			current = &runs[candidateIndex];
+			stepIndex = candidateStepIndex;
+			continue;
+		}
+
+		while (true) {
+			if (stepIndex == current->steps.size() && !extendCurrent(*current)) {
+				return ret;
+			}
+
+			const Step& step = current->steps[stepIndex];
+			if (step.end > candidate.lastBoundary()) {
+				// past everything the candidate has parsed, so it is of no use
+				break;
+			}
+
+			take(step);
+			++stepIndex;
+
+			candidateStepIndex = candidate.stepsAfterBoundary(step.end);
+			if (candidateStepIndex != std::string::npos) {
+				current = &runs[candidateIndex];
+				stepIndex = candidateStepIndex;
+				break;
+			}
+		}
+	}
+
+	while (stepIndex < current->steps.size() || extendCurrent(*current)) {
+		take(current->steps[stepIndex++]);
+	}
+
+	return ret;
+}
+
+template <typename ParserType>
+inline std::vector<std::pair<size_t, typename ParallelParser<ParserType>::InputIterator>> ParallelParser<ParserType>::splitIntoSegments(const std::list<InputTypePtr>& input) const {
+	const size_t segmentCount = std::max<size_t>(std::min<size_t>(m_threadCount * SEGMENTS_PER_THREAD, input.size() / MIN_SEGMENT_SIZE), 1);
+	const size_t segmentSize = input.size() / segmentCount;
+
+	std::vector<std::pair<size_t, InputIterator>> ret({ { 0, input.cbegin() } });
+	size_t index = 0;
+	for (auto inputIt = input.cbegin(); inputIt != input.cend(); ++index) {
+		const bool synchronizing = ParserType::isSynchronizing(*inputIt);
+		++inputIt;
+		if (synchronizing && index + 1 >= ret.back().first + segmentSize && inputIt != input.cend()) {
+			ret.emplace_back(index + 1, inputIt);
+		}
+	}
+
+	return ret;
+}
+
+template <typename ParserType>
+inline void ParallelParser<ParserType>::speculate(Run& run, const std::list<InputTypePtr>& input, size_t limit) {
+	while (run.lastBoundary() < limit && extend(run, input)) { }
+}
+
+template <typename ParserType>
+inline bool ParallelParser<ParserType>::extend(Run& run, const std::list<InputTypePtr>& input) {
+	if (run.finished()) {
+		return false;
+	}
+
+	if (!run.stream) {
+		run.parser = std::make_unique<ParserType>();
+		run.stream = std::make_unique<ListProductionStream<typename InputStream::StreamElement>>(input, run.startIterator);
+		if (!run.stream->good()) {
+			return false;
+		}
+	}
+
+	// just like parseStream does it
+	try {
+		auto production = run.parser->parse(*run.stream);
+		run.steps.push_back({ production, run.start + run.stream->offset() });
+	} catch (...) {
+		// a speculative run may well have started in the middle of a root, so this only matters if the correct run gets here
+		run.exception = std::current_exception();
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "RawStream.h"
+
+/*
+	Tokenizes input that is already in memory (say a mapped file) with a machine on raw input on several threads at once, producing the very same productions as processStream would.
+	The input is split into chunks and every chunk is tokenized speculatively by a machine of its own, starting at the beginning of the chunk as if a token started there.
+	As the machine gets back to its initial state after every token, the tokenization of a chunk is known to be right from the first token boundary it shares with the correct tokenization of the chunk before it;
+	every speculative run therefore goes a bit past the beginning of the next chunk, and the runs are stitched together at such shared boundaries. Should the runs never meet, the correct one is simply continued.
+	The chunks start right after a line break if there is one close by, which is where the tokens of most grammars resynchronize anyway.
+*/
+template <typename MachineType>
+class ParallelTokenizer {
+public:
+	typedef decltype(std::declval<MachineType&>().apply(std::declval<RawStream&>())) OutputProductionPtr;
+
+	ParallelTokenizer(unsigned int threadCount = 0)
+		: m_threadCount(threadCount) {
+		if (m_threadCount == 0) {
+			m_threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+	}
+
+	std::list<OutputProductionPtr> processStream(const char* begin, const char* end, const std::shared_ptr<Location>& startingLocation);
+	std::list<OutputProductionPtr> processStreamWithIgnorance(const char* begin, const char* end, const std::shared_ptr<Location>& startingLocation);
+
+	unsigned int threadCount() const { return m_threadCount; }
+
+private:
+	// chunks smaller than this are not worth a thread
+	static constexpr size_t MIN_CHUNK_SIZE = 64 * 1024;
+	// how far past the beginning of the next chunk a speculative run goes looking for a boundary it shares with the next run
+	static constexpr size_t SPECULATION_OVERLAP = 4096;
+	// how far into a chunk its beginning may be moved to get right past a line break
+	static constexpr size_t MAX_LINE_BREAK_SEARCH = 1024;
+
+	struct Step {
+		OutputProductionPtr production;
+		size_t end; // the offset of the input the application stopped at
+		bool last; // whether processStream would stop after this application
+	};
+
+	struct Run {
+		size_t start;
+		std::shared_ptr<Location> startLocation;
+		std::vector<Step> steps;
+		std::unique_ptr<MachineType> machine;
+		std::unique_ptr<MemoryStream> stream;
+		size_t streamStart; // the offset of the input the stream starts at
+
+		bool finished() const { return !steps.empty() && steps.back().last; }
+		size_t lastBoundary() const { return steps.empty() ? start : steps.back().end; }
+		// the index of the step after the given token boundary, or npos if the run does not stop at it
+		// the beginning of the run does not count, as the first production read off a stream is located differently from those that follow another one
+		size_t stepsAfterBoundary(size_t boundary) const;
+	};
+
+	unsigned int m_threadCount;
+
+	std::list<OutputProductionPtr> process(const char* begin, const char* end, const std::shared_ptr<Location>& startingLocation, bool withIgnorance);
+	std::vector<size_t> splitIntoChunks(const char* begin, const char* end) const;
+	static void speculate(Run& run, const char* begin, const char* end, size_t limit);
+	static bool extend(Run& run, const char* begin, const char* end);
+};
+
+template <typename MachineType>
+inline std::list<typename ParallelTokenizer<MachineType>::OutputProductionPtr> ParallelTokenizer<MachineType>::processStream(const char* begin, const char* end, const std::shared_ptr<Location>& startingLocation) {
+	return process(begin, end, startingLocation, false);
+}
+
+template <typename MachineType>
+inline std::list<typename ParallelTokenizer<MachineType>::OutputProductionPtr> ParallelTokenizer<MachineType>::processStreamWithIgnorance(const char* begin, const char* end, const std::shared_ptr<Location>& startingLocation) {
+	return process(begin, end, startingLocation, true);
+}
+
+template <typename MachineType>
+inline size_t ParallelTokenizer<MachineType>::Run::stepsAfterBoundary(size_t boundary) const {
+	auto stepIt = std::lower_bound(steps.cbegin(), steps.cend(), boundary, [](const Step& step, size_t offset) { return step.end < offset; });
+	if (stepIt == steps.cend() || stepIt->end != boundary) {
+		return std::string::npos;
+	}
+	return stepIt - steps.cbegin() + 1;
+}
+
+template <typename MachineType>
+inline std::list<typename ParallelTokenizer<MachineType>::OutputProductionPtr> ParallelTokenizer<MachineType>::process(const char* begin, const char* end, const std::shared_ptr<Location>& startingLocation, bool withIgnorance) {
+	const std::vector<size_t> chunkStarts = splitIntoChunks(begin, end);
+
+	// the locations the chunks start at are found up front, it takes a fraction of the time the tokenization does
+	std::vector<Run> runs(chunkStarts.size());
+	auto location = startingLocation->clone();
+	for (size_t chunkIndex = 0; chunkIndex < chunkStarts.size(); ++chunkIndex) {
+		if (chunkIndex > 0) {
+			location->noteAll(begin + chunkStarts[chunkIndex - 1], begin + chunkStarts[chunkIndex]);
+		}
+		runs[chunkIndex].start = chunkStarts[chunkIndex];
+		runs[chunkIndex].startLocation = location->clone();
+	}
+
+	std::atomic<size_t> nextChunkIndex(0);
+	auto work = [&]() {
+		for (size_t chunkIndex = nextChunkIndex++; chunkIndex < runs.size(); chunkIndex = nextChunkIndex++) {
+			const size_t limit = chunkIndex + 1 < runs.size() ? runs[chunkIndex + 1].start + SPECULATION_OVERLAP : end - begin;
+			speculate(runs[chunkIndex], begin, end, limit);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int threadIndex = 1; threadIndex < std::min<size_t>(m_threadCount, runs.size()); ++threadIndex) {
+		threads.emplace_back(work);
+	}
+	work();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	// follow the correct run, switching over to the next one as soon as they meet
+	std::list<OutputProductionPtr> ret;
+	auto take = [&ret, withIgnorance](const Step& step) {
+		if (step.production || !withIgnorance) {
+			ret.push_back(step.production);
+		}
+	};
+
+	Run* current = &runs[0];
+	size_t stepIndex = 0;
+	for (size_t candidateIndex = 1; candidateIndex < runs.size(); ++candidateIndex) {
+		const Run& candidate = runs[candidateIndex];
+		// having given up on the candidate before, the correct run may already be past the beginning of this one
+		const size_t boundaryReached = stepIndex == 0 ? current->start : current->steps[stepIndex - 1].end;
+		size_t candidateStepIndex = candidate.stepsAfterBoundary(boundaryReached);
+		if (candidateStepIndex != std::string::npos) {
+			current = &runs[candidateIndex];
+			stepIndex = candidateStepIndex;
+			continue;
+		}
+
+		while (true) {
+			if (stepIndex == current->steps.size() && !extend(*current, begin, end)) {
+				return ret;
+			}
+
+			const Step& step = current->steps[stepIndex];
+			if (step.end > candidate.lastBoundary()) {
+				// past everything the candidate has found, so it is of no use
+				break;
+			}
+
+			take(step);
+			++stepIndex;
+			if (step.last) {
+				return ret;
+			}
+
+			candidateStepIndex = candidate.stepsAfterBoundary(step.end);
+			if (candidateStepIndex != std::string::npos) {
+				current = &runs[candidateIndex];
+				stepIndex = candidateStepIndex;
+				break;
+			}
+		}
+	}
+
+	while (stepIndex < current->steps.size() || extend(*current, begin, end)) {
+		const Step& step = current->steps[stepIndex++];
+		take(step);
+		if (step.last) {
+			break;
+		}
+	}
+
+	return ret;
+}
+
+template <typename MachineType>
+inline std::vector<size_t> ParallelTokenizer<MachineType>::splitIntoChunks(const char* begin, const char* end) const {
+	const size_t length = end - begin;
+	const size_t chunkCount = std::max<size_t>(std::min<size_t>(m_threadCount, length / MIN_CHUNK_SIZE), 1);
+
+	std::vector<size_t> ret({ 0 });
+	for (size_t chunkIndex = 1; chunkIndex < chunkCount; ++chunkIndex) {
+		size_t chunkStart = length / chunkCount * chunkIndex;
+		const void* lineBreak = std::memchr(begin + chunkStart, '\n', std::min(MAX_LINE_BREAK_SEARCH, length - chunkStart));
+		if (lineBreak != nullptr) {
+			chunkStart = static_cast<const char*>(lineBreak) - begin + 1;
+		}
+
+		if (chunkStart > ret.back() && chunkStart < length) {
+			ret.push_back(chunkStart);
+		}
+	}
+
+	return ret;
+}
+
+template <typename MachineType>
+inline void ParallelTokenizer<MachineType>::speculate(Run& run, const char* begin, const char* end, size_t limit) {
+	try {
+		while (run.lastBoundary() < limit && extend(run, begin, end)) { }
+	} catch (...) {
+		// the run might well have started in the middle of a token, so whatever went wrong only matters if the correct run gets here too -- in which case it will go wrong again
+		run.machine.reset();
+		run.stream.reset();
+	}
+}
+
+template <typename MachineType>
+inline bool ParallelTokenizer<MachineType>::extend(Run& run, const char* begin, const char* end) {
+	if (run.finished()) {
+		return false;
+	}
+
+	if (!run.stream) {
+		auto location = run.startLocation->clone();
+		location->noteAll(begin + run.start, begin + run.lastBoundary());
+		run.machine = std::make_unique<MachineType>();
+		run.streamStart = run.lastBoundary();
+		run.stream = std::make_unique<MemoryStream>(begin + run.streamStart, end, location);
+	}
+
+	// just like processStream does it
+	auto production = run.machine->apply(*run.stream);
+	const bool wasApplicationSuccessful = run.machine->lastApplicationSuccessful();
+	if (wasApplicationSuccessful) {
+		run.machine->reset();
+	}
+
+	run.steps.push_back({ production, run.streamStart + run.stream->offset(), !wasApplicationSuccessful || !run.stream->good() });
+	return true;
+}
@@ -69,6 +69,7 @@ inline std::shared_ptr<OutputProductionType> Parser<InputStreamType, OutputProdu
 
 template<typename InputStreamType, typename OutputProductionType>
 inline std::list<std::shared_ptr<OutputProductionType>> Parser<InputStreamType, OutputProductionType>::parseStream(InputStreamType& rs) {
+	ASTIR_TRACE("parseStream", "parse");
 	std::list<std::shared_ptr<OutputProductionType>> ret;
 
 	while (rs.good()) {
@@ -81,6 +82,7 @@ inline std::list<std::shared_ptr<OutputProductionType>> Parser<InputStreamType,
 
 template<typename InputStreamType, typename OutputProductionType>
 inline std::list<std::shared_ptr<OutputProductionType>> Parser<InputStreamType, OutputProductionType>::parseStreamWithIgnorance(InputStreamType& rs) {
+	ASTIR_TRACE("parseStreamWithIgnorance", "parse");
 	std::list<std::shared_ptr<OutputProductionType>> ret;
 
 	while (rs.good()) {
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+	The profile of the productions of a parser generated with `--profileParsers`.
+	Every parse_ function of such a parser (parse_root included) opens a Scope for its production on being called, which counts the call, the time spent in the production
+	both including and excluding the time spent in the productions it calls, and how far ahead of the current position the decisions of the production had to peek.
+	The time of recursive calls only counts once towards the inclusive time of a production, for its outermost call.
+*/
+class ParserProfiler {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	struct ProductionProfile {
+		std::string name;
+		size_t calls;
+		Clock::duration inclusiveTime;
+		Clock::duration exclusiveTime;
+		size_t maxLookahead; // the most input productions a decision of the production had to look at
+
+		ProductionProfile(const std::string& name)
+			: name(name), calls(0), inclusiveTime(Clock::duration::zero()), exclusiveTime(Clock::duration::zero()), maxLookahead(0) { }
+	};
+
+	class Scope {
+	public:
+		Scope(ParserProfiler& profiler, size_t production)
+			: m_profiler(profiler), m_production(production), m_parent(profiler.m_innermostScope), m_childTime(Clock::duration::zero()), m_start(Clock::now()) {
+			++m_profiler.m_profiles[m_production].calls;
+			++m_profiler.m_activeCalls[m_production];
+			m_profiler.m_innermostScope = this;
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope();
+
+		// wraps the index of every peek a decision of the production makes, returning it as it is
+		size_t lookahead(size_t ahead) {
+			ProductionProfile& profile = m_profiler.m_profiles[m_production];
+			profile.maxLookahead = std::max(profile.maxLookahead, ahead + 1);
+			return ahead;
+		}
+
+	private:
+		ParserProfiler& m_profiler;
+		size_t m_production;
+		Scope* m_parent;
+		Clock::duration m_childTime;
+		Clock::time_point m_start;
+	};
+
+	ParserProfiler(const std::vector<std::string>& productionNames)
+		: m_activeCalls(productionNames.size(), 0), m_innermostScope(nullptr) {
+		m_profiles.reserve(productionNames.size());
+		for (const auto& productionName : productionNames) {
+			m_profiles.emplace_back(productionName);
+		}
+	}
+
+	const std::vector<ProductionProfile>& profiles() const { return m_profiles; }
+	std::vector<ProductionProfile> rankByCost() const; // the productions that have been called, the most exclusive time first
+	void report(std::ostream& output) const;
+	void reset();
+
+private:
+	std::vector<ProductionProfile> m_profiles;
+	std::vector<size_t> m_activeCalls; // by production, how many of its calls are on the stack
+	Scope* m_innermostScope;
+};
+
+inline ParserProfiler::Scope::~Scope() {
+	const Clock::duration elapsed = Clock::now() - m_start;
+	ProductionProfile& profile = m_profiler.m_profiles[m_production];
+	profile.exclusiveTime += elapsed - m_childTime;
+	if (--m_profiler.m_activeCalls[m_production] == 0) {
+		profile.inclusiveTime += elapsed;
+	}
+
+	if (m_parent != nullptr) {
+		m_parent->m_childTime += elapsed;
+	}
+	m_profiler.m_innermostScope = m_parent;
+}
+
+inline std::vector<ParserProfiler::ProductionProfile> ParserProfiler::rankByCost() const {
+	std::vector<ProductionProfile> ret;
+	std::copy_if(m_profiles.cbegin(), m_profiles.cend(), std::back_inserter(ret), [](const ProductionProfile& profile) { return profile.calls > 0; });
+	std::stable_sort(ret.begin(), ret.end(), [](const ProductionProfile& lhs, const ProductionProfile& rhs) { return lhs.exclusiveTime > rhs.exclusiveTime; });
+	return ret;
+}
+
+inline void ParserProfiler::report(std::ostream& output) const {
+	const auto ranking = rankByCost();
+	Clock::duration totalTime = Clock::duration::zero();
+	size_t nameWidth = 10;
+	for (const auto& profile : ranking) {
+		totalTime += profile.exclusiveTime;
+		nameWidth = std::max(nameWidth, profile.name.size());
+	}
+
+	auto milliseconds = [](Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+	const auto flags = output.flags();
+	const auto precision = output.precision();
+	output << std::left << std::setw(nameWidth) << "production" << std::right
+		<< std::setw(12) << "calls" << std::setw(16) << "inclusive ms" << std::setw(16) << "exclusive ms" << std::setw(10) << "share" << std::setw(12) << "ns/call" << std::setw(11) << "lookahead" << std::endl;
+	output << std::fixed;
+	for (const auto& profile : ranking) {
+		const double share = totalTime.count() > 0 ? 100.0 * profile.exclusiveTime.count() / totalTime.count() : 0.0;
+		output << std::left << std::setw(nameWidth) << profile.name << std::right
+			<< std::setw(12) << profile.calls
+			<< std::setprecision(3) << std::setw(16) << milliseconds(profile.inclusiveTime) << std::setw(16) << milliseconds(profile.exclusiveTime)
+			<< std::setprecision(1) << std::setw(9) << share << '%'
+			<< std::setprecision(0) << std::setw(12) << std::chrono::duration<double, std::nano>(profile.exclusiveTime).count() / profile.calls
+			<< std::setw(11) << profile.maxLookahead << std::endl;
+	}
+	output.flags(flags);
+	output.precision(precision);
+}
+
+inline void ParserProfiler::reset() {
+	for (auto& profile : m_profiles) {
+		profile = ProductionProfile(profile.name);
+	}
+}
@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "Location.h"
+#include "AllocationAccounting.h"
 
 class ILocalizable {
 public:
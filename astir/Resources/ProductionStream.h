@@ -7,7 +7,9 @@
 #include "Production.h"
 #include "Terminal.h"
 #include "Exception.h"
+#include "Instrumentation.h"
 
+#include <algorithm>
 #include <stack>
 
 class ProductionStreamException : public Exception {
@@ -43,6 +45,14 @@ public:
 	std::shared_ptr<Location> lastPinLocation() const;
 	const std::shared_ptr<Location>& lastLocation() const { return m_lastLocation; }
 
+	// what the machines reading the stream have done so far, see Instrumentation.h
+#ifdef ASTIR_INSTRUMENTATION
+	const InstrumentationCounters& counters() const { return m_counters; }
+	InstrumentationCounters& counters() { return m_counters; }
+#else
+	const InstrumentationCounters& counters() const { static const InstrumentationCounters none; return none; }
+#endif
+
 protected:
 	ProductionStream(const std::shared_ptr<Location>& startingStreamLocation)
 		: m_buffer(), m_nextProductionToGive(0), m_bufferFixed(false), m_lastLocation(startingStreamLocation), m_bufferStartLocation(startingStreamLocation) { }
@@ -50,6 +60,19 @@ protected:
 	virtual bool streamGet(StreamElementPtr& c) = 0;
 	virtual bool streamGood() const = 0;
 
+	// productions may only be skipped (dropped from the buffer or never even put in it) when nobody can return to them anymore
+	bool bypassable() const { return m_pins.empty() && !m_bufferFixed && m_nextProductionToGive == 0; }
+	// returns how many have been dropped, lastDroppedLocation being set to the location of the last of them (if any)
+	template <typename Predicate>
+	size_t dropBufferedWhile(Predicate predicate, std::shared_ptr<Location>& lastDroppedLocation);
+	bool bufferEmpty() const { return m_buffer.empty(); }
+	size_t bufferedAhead() const { return m_buffer.size() - m_nextProductionToGive; } // how many have been buffered but not given yet
+	// leaves the locations as if the bypassed productions had been read one by one as a token, along with the one buffered after them (if any), and the stream had then returned to the latter,
+	// just like it is after a machine reads past the end of a token: the buffer starting where the stream was before the bypassing, the last location being that of the production read past the end
+	void noteBypassed(const std::shared_ptr<Location>& locationBeforeBypassing, const std::shared_ptr<Location>& lastBypassedLocation);
+	// forgets everything buffered and pinned so far, keeping the memory of the buffers, for the stream to start over on other input
+	void restart(const std::shared_ptr<Location>& startingStreamLocation);
+
 private:
 	bool m_bufferFixed;
 	size_t m_nextProductionToGive;
@@ -65,6 +88,10 @@ private:
 	
 	std::shared_ptr<Location> m_lastLocation;
 	std::shared_ptr<Location> m_bufferStartLocation;
+
+#ifdef ASTIR_INSTRUMENTATION
+	InstrumentationCounters m_counters;
+#endif
 };
 
 template <class ProductionType>
@@ -72,7 +99,13 @@ class ListProductionStream : public ProductionStream<ProductionType> {
 public:
 	ListProductionStream(const std::list<std::shared_ptr<ProductionType>>& inputProductionList)
 		: ProductionStream<ProductionType>(inputProductionList.empty() ? std::make_shared<InvalidLocation>() : inputProductionList.front()->location()),
-		m_list(inputProductionList), m_iterator(m_list.cbegin()) { }
+		m_list(inputProductionList), m_iterator(m_list.cbegin()), m_taken(0) { }
+	// streams the productions from the given one on, for ParallelParser to parse a part of the list
+	ListProductionStream(const std::list<std::shared_ptr<ProductionType>>& inputProductionList, typename std::list<std::shared_ptr<ProductionType>>::const_iterator start)
+		: ProductionStream<ProductionType>(start == inputProductionList.cend() ? std::make_shared<InvalidLocation>() : (*start)->location()),
+		m_list(inputProductionList), m_iterator(start), m_taken(0) { }
+
+	size_t offset() const { return m_taken - this->bufferedAhead(); } // how many productions have been given since the start
 
 protected:
 	bool streamGet(std::shared_ptr<ProductionType>& c) override;
@@ -81,6 +114,7 @@ protected:
 private:
 	const std::list<std::shared_ptr<ProductionType>>& m_list;
 	typename std::list<std::shared_ptr<ProductionType>>::const_iterator m_iterator;
+	size_t m_taken;
 };
 
 template<class ProductionType>
@@ -96,6 +130,7 @@ inline bool ProductionStream<ProductionType>::get(StreamElementPtr& c) {
 
 		if (ret) {
 			m_buffer.push_back(c);
+			ASTIR_INSTRUMENT(m_counters.maxBufferedProductions = std::max(m_counters.maxBufferedProductions, m_buffer.size()));
 			++m_nextProductionToGive;
 			m_lastLocation = c->location();
 		}
@@ -112,6 +147,7 @@ inline std::shared_ptr<ProductionType> ProductionStream<ProductionType>::peek(si
 
 		if (status) {
 			m_buffer.push_back(c);
+			ASTIR_INSTRUMENT(m_counters.maxBufferedProductions = std::max(m_counters.maxBufferedProductions, m_buffer.size()));
 		} else {
 			return nullptr;
 		}
@@ -141,6 +177,7 @@ inline bool ProductionStream<ProductionType>::good() const {
 template<class ProductionType>
 inline void ProductionStream<ProductionType>::pin() {
 	m_pins.push(Pin(m_nextProductionToGive, m_lastLocation));
+	ASTIR_INSTRUMENT(m_counters.maxPinDepth = std::max(m_counters.maxPinDepth, m_pins.size()));
 }
 
 template<class ProductionType>
@@ -226,6 +263,36 @@ inline void ProductionStream<ProductionType>::resetToPositionRelativeToLastPin(s
 	}
 }
 
+template<class ProductionType>
+template<typename Predicate>
+inline size_t ProductionStream<ProductionType>::dropBufferedWhile(Predicate predicate, std::shared_ptr<Location>& lastDroppedLocation) {
+	size_t dropped = 0;
+	while (!m_buffer.empty() && predicate(*m_buffer.front())) {
+		lastDroppedLocation = m_buffer.front()->location();
+		m_buffer.pop_front();
+		++dropped;
+	}
+	return dropped;
+}
+
+template<class ProductionType>
+inline void ProductionStream<ProductionType>::noteBypassed(const std::shared_ptr<Location>& locationBeforeBypassing, const std::shared_ptr<Location>& lastBypassedLocation) {
+	m_bufferStartLocation = locationBeforeBypassing;
+	m_lastLocation = m_buffer.empty() ? lastBypassedLocation : m_buffer.front()->location();
+}
+
+template<class ProductionType>
+inline void ProductionStream<ProductionType>::restart(const std::shared_ptr<Location>& startingStreamLocation) {
+	m_buffer.clear();
+	m_nextProductionToGive = 0;
+	m_bufferFixed = false;
+	while (!m_pins.empty()) {
+		m_pins.pop();
+	}
+	m_lastLocation = startingStreamLocation;
+	m_bufferStartLocation = startingStreamLocation;
+}
+
 template<class ProductionType>
 inline std::shared_ptr<Location> ProductionStream<ProductionType>::lastPinLocation() const {
 	if (m_pins.empty()) {
@@ -241,6 +308,7 @@ inline bool ListProductionStream<ProductionType>::streamGet(std::shared_ptr<Prod
 	if (m_iterator != m_list.cend()) {
 		c = *m_iterator;
 		++m_iterator;
+		++m_taken;
 
 		return true;
 	}
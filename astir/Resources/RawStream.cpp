@@ -1,21 +1,138 @@
 #include "ProductionStream.h"
 #include "RawStream.h"
 
-bool RawStream::streamGet(std::shared_ptr<RawTerminal>& c) {
-    char payload;
-    bool ret = bool{ m_underlyingStream.get(payload) };
+#include <algorithm>
+
+size_t RawStream::skipWhile(const ByteClass& byteClass) {
+    if (!bypassable()) {
+        return 0;
+    }
+
+    const std::shared_ptr<Location> locationBeforeSkipping = lastLocation();
+    std::shared_ptr<Location> lastSkippedLocation;
+
+    // the terminals already made (typically the one read past the end of the last token) go first
+    size_t skipped = dropBufferedWhile([&byteClass](const RawTerminal& terminal) { return byteClass.contains((unsigned char)terminal.type); }, lastSkippedLocation);
 
-    if (ret) {
-        m_currentStreamLocation->note(payload);
-        c = std::make_shared<RawTerminal>(payload, m_currentStreamLocation->clone());
+    size_t chunkSkipped = 0;
+    while (bufferEmpty() && (m_chunkPosition < m_chunk.size() || refillChunk())) {
+        const size_t span = byteClass.span(m_chunk.data() + m_chunkPosition, m_chunk.data() + m_chunk.size());
+        m_currentStreamLocation->noteAll(m_chunk.data() + m_chunkPosition, m_chunk.data() + m_chunkPosition + span);
+        m_chunkPosition += span;
+        m_bytesTaken += span;
+        chunkSkipped += span;
+
+        if (m_chunkPosition < m_chunk.size()) {
+            break;
+        }
+    }
+
+    if (chunkSkipped > 0) {
+        lastSkippedLocation = m_currentStreamLocation->clone();
     }
 
-    return ret;
+    // reading them one by one, the machine would have read the byte after them too before returning to it
+    if (skipped + chunkSkipped > 0) {
+        peek();
+        noteBypassed(locationBeforeSkipping, lastSkippedLocation);
+    }
+    return skipped + chunkSkipped;
+}
+
+size_t RawStream::advanceWhile(const ByteClass& byteClass) {
+    size_t advanced = 0;
+    std::shared_ptr<RawTerminal> terminal;
+
+    // the terminals already buffered ahead (e.g. after a machine has returned to a branching point) go one by one
+    while (bufferedAhead() > 0) {
+        bool followedByMember;
+        if (bufferedAhead() > 1) {
+            followedByMember = byteClass.contains((unsigned char)peek(1)->type);
+        } else {
+            followedByMember = m_chunkPosition < m_chunk.size() && byteClass.contains((unsigned char)m_chunk[m_chunkPosition]);
+        }
+
+        if (!followedByMember || !byteClass.contains((unsigned char)peek()->type)) {
+            return advanced;
+        }
+        get(terminal);
+        ++advanced;
+    }
+
+    // the rest of the run is found in the chunk in one go
+    const size_t span = byteClass.span(m_chunk.data() + m_chunkPosition, m_chunk.data() + m_chunk.size());
+    for (size_t counter = 1; counter < span; ++counter) {
+        get(terminal);
+        ++advanced;
+    }
+
+    return advanced;
+}
+
+bool RawStream::streamGet(std::shared_ptr<RawTerminal>& c) {
+    if (m_chunkPosition == m_chunk.size() && !refillChunk()) {
+        return false;
+    }
+
+    char payload = m_chunk[m_chunkPosition++];
+    ++m_bytesTaken;
+    m_currentStreamLocation->note(payload);
+    c = makeAccounted<RawTerminal>("RawTerminal", payload, m_currentStreamLocation->clone());
+
+    return true;
 }
 
 bool RawStream::streamGood() const {
-    return m_underlyingStream.good();
+    return m_chunkPosition < m_chunk.size() || m_underlyingStream.good();
+}
+
+void RawStream::restart(const std::shared_ptr<Location>& startingStreamLocation) {
+    ProductionStream<RawTerminal>::restart(startingStreamLocation);
+    m_currentStreamLocation = startingStreamLocation->clone();
+    m_chunk.clear();
+    m_chunkPosition = 0;
+    m_bytesTaken = 0;
+    m_underlyingStream.clear();
+}
+
+bool RawStream::refillChunk() {
+    m_chunk.clear();
+    m_chunkPosition = 0;
+
+    // reading ahead of a stream someone else may read past the last token would take the bytes away from them
+    std::streamsize available = m_ownsUnderlyingStream && m_underlyingStream.good() ? m_underlyingStream.rdbuf()->in_avail() : 0;
+    if (available > 0) {
+        m_chunk.resize(std::min((size_t)available, CHUNK_SIZE));
+        m_underlyingStream.read(m_chunk.data(), m_chunk.size());
+        m_chunk.resize((size_t)m_underlyingStream.gcount());
+    } else {
+        // nothing is known to be available, so only block for as much as a single byte, just like reading byte by byte would
+        char payload;
+        if (m_underlyingStream.get(payload)) {
+            m_chunk.push_back(payload);
+        }
+    }
+
+    return !m_chunk.empty();
 }
 
 TextFileStream::TextFileStream(const std::string& fileName)
-    : m_fileStream(fileName), RawStream(m_fileStream, std::make_shared<TextFileLocation>(fileName, 1, 0)) { }
+    : m_fileStream(fileName), RawStream(m_fileStream, std::make_shared<TextFileLocation>(fileName, 1, 0), true) { }
+
+MemoryStream::MemoryStream(const char* begin, const char* end, const std::shared_ptr<Location>& startingStreamLocation)
+    : m_memoryBuffer(begin, end), m_memoryStream(&m_memoryBuffer), RawStream(m_memoryStream, startingStreamLocation, true) { }
+
+void MemoryStream::reset(const char* begin, const char* end, const std::shared_ptr<Location>& startingStreamLocation) {
+    m_memoryBuffer.reset(begin, end);
+    restart(startingStreamLocation);
+}
+
+MemoryStream::MemoryBuffer::MemoryBuffer(const char* begin, const char* end) {
+    reset(begin, end);
+}
+
+void MemoryStream::MemoryBuffer::reset(const char* begin, const char* end) {
+    // the buffer is only ever read from
+    char* data = const_cast<char*>(begin);
+    setg(data, data, data + (end - begin));
+}
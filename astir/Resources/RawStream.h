@@ -1,9 +1,11 @@
 #pragma once
 
 #include <istream>
+#include <vector>
 
 #include "ProductionStream.h"
 #include "Terminal.h"
+#include "ByteClass.h"
 
 class RawTerminal : public Terminal<char> {
 public:
@@ -17,17 +19,46 @@ public:
 
 class RawStream : public ProductionStream<RawTerminal> {
 public:
+	// the stream given is only ever read byte by byte, as it may well be read by someone else once the raw stream is done with it
 	RawStream(std::istream& underlyingStream, const std::shared_ptr<Location>& startingStreamLocation)
-		: m_underlyingStream(underlyingStream), m_currentStreamLocation(startingStreamLocation), ProductionStream<RawTerminal>(startingStreamLocation) { }
+		: RawStream(underlyingStream, startingStreamLocation, false) { }
+
+	// skips the run of members of the byte class the stream continues with without making terminals of them, returns its length
+	// nothing is skipped unless the stream is bypassable, i.e. there is no pin or peek to return to the skipped bytes
+	size_t skipWhile(const ByteClass& byteClass);
+	// reads through the run of members of the byte class the stream continues with, all but its last member, which is left to be read by whoever knows what to do about the end of the run
+	// returns how many have been read, just as if they had been read by get() one by one
+	size_t advanceWhile(const ByteClass& byteClass);
+
+	// how many bytes of the underlying stream have been read, skipped, or otherwise got past so far (the ones buffered ahead do not count)
+	size_t offset() const { return m_bytesTaken - bufferedAhead(); }
 
 protected:
+	// the streams owned by the raw stream (and hence read by nobody else) are read ahead as far as they are available without blocking
+	RawStream(std::istream& underlyingStream, const std::shared_ptr<Location>& startingStreamLocation, bool ownsUnderlyingStream)
+		: m_underlyingStream(underlyingStream), m_ownsUnderlyingStream(ownsUnderlyingStream), m_currentStreamLocation(startingStreamLocation->clone()), m_chunk(), m_chunkPosition(0), m_bytesTaken(0), ProductionStream<RawTerminal>(startingStreamLocation) { }
+
 	bool streamGet(std::shared_ptr<RawTerminal>& c) override;
 	bool streamGood() const override;
 
+	// starts over on whatever the underlying stream continues with, keeping the memory of the buffers
+	void restart(const std::shared_ptr<Location>& startingStreamLocation);
+
 private:
+	static constexpr size_t CHUNK_SIZE = 4096;
+
 	std::istream& m_underlyingStream;
+	bool m_ownsUnderlyingStream;
+
+	std::shared_ptr<Location> m_currentStreamLocation; // keeps changing as the stream is read, so it is a copy of the starting location rather than the location the first terminals refer to
 
-	std::shared_ptr<Location> m_currentStreamLocation;
+	// read ahead of what has been made into terminals, so that runs of bytes can be scanned in one go
+	// only as much as is available without blocking is read ahead, and only from owned streams, the others leaving a single byte at a time in here
+	std::vector<char> m_chunk;
+	size_t m_chunkPosition;
+	size_t m_bytesTaken; // out of the chunks, whether made into terminals or skipped
+
+	bool refillChunk();
 };
 
 #include <fstream>
@@ -38,4 +69,26 @@ public:
 
 private:
 	std::ifstream m_fileStream;
+};
+
+#include <streambuf>
+
+// a raw stream over bytes that already are in memory (e.g. a file mapped into it), which have to stay there for as long as the stream is used
+class MemoryStream : public RawStream {
+public:
+	MemoryStream(const char* begin, const char* end, const std::shared_ptr<Location>& startingStreamLocation);
+
+	// starts over on other bytes, as if the stream had just been constructed on them but reusing its buffers
+	void reset(const char* begin, const char* end, const std::shared_ptr<Location>& startingStreamLocation);
+
+private:
+	class MemoryBuffer : public std::streambuf {
+	public:
+		MemoryBuffer(const char* begin, const char* end);
+
+		void reset(const char* begin, const char* end);
+	};
+
+	MemoryBuffer m_memoryBuffer;
+	std::istream m_memoryStream;
 };
\ No newline at end of file
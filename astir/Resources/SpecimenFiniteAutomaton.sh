@@ -58,37 +58,92 @@ namespace ${{MachineName}} {
 	typedef std::shared_ptr<${{InputTerminalTypeName}}> InputTerminalPtr;
 
 	class ${{MachineName}};
-	typedef void (${{MachineName}}::* ActionMethodPointer)(size_t, const std::deque<InputTerminalPtr>&, const std::shared_ptr<Location>&);
+	// identifies the sequence of actions to be executed by executeActionRegister, 0 for none
+	typedef ${{ActionRegisterTypeName}} ActionRegister;
 	class ${{MachineName}} : public Machine<InputStream, OutputProduction> {
 	public:
-		${{MachineName}}()
-			: m_currentState(0) { }
-
-		std::shared_ptr<OutputProduction> apply(InputStream& rs) override;
-
-		bool lastApplicationSuccessful() const override { return m_stateFinality[m_currentState]; }
-		void reset() override;
+		/*
+			Everything that changes as the machine runs, whereas the tables and the rest of the machine stay the same.
+			A single machine can thus be applied on any number of threads at once, as long as each one of them brings a run state of its own;
+			the overloads without one use the run state of the machine itself (and so does the peeking mechanism).
+		*/
+		class RunState {
+		public:
+			RunState()
+				: m_currentState(0) { }
+
+		private:
+			friend class ${{MachineName}};
+
+			// state-switching internals
+			State m_currentState;
+
+			// raw-capture internals
+			std::stack<size_t> m_captureStack;
+
+			// the bookkeeping of apply, kept here for its buffers to be reused by the applications that follow
+			struct BranchingPoint {
+				size_t inputPosition;
+				size_t actionStackPosition;
+				std::vector<State> remainingStates;
+				std::vector<ActionRegister> remainingActions;
+
+				BranchingPoint(size_t inputPosition,
+						size_t actionStackPosition,
+						const std::vector<State>& remainingStates,
+						const std::vector<ActionRegister>& remainingActions)
+					: inputPosition(inputPosition), actionStackPosition(actionStackPosition),
+					remainingStates(remainingStates), remainingActions(remainingActions) { }
+			};
+			struct ActionPack {
+				ActionRegister action;
+				size_t position;
+				std::shared_ptr<Location> location;
+
+				ActionPack()
+					: action(0), position((size_t)-1), location(nullptr) { }
+				ActionPack(ActionRegister action, size_t position, const std::shared_ptr<Location>& location)
+					: action(action), position(position), location(location) { }
+			};
+			std::vector<ActionPack> m_actionStack;
+			std::vector<ActionPack> m_lastAcceptedActionStack;
+			std::vector<BranchingPoint> m_branchingPoints;
+
+			// dependency machines
+			${{DependencyMachineFields}}
+			// action contexts
+			std::shared_ptr<OutputProduction> m_token;
+			${{ActionContextsDeclarations}}
+			// actions
+			void executeActionRegister(ActionRegister actionRegister, size_t position, const std::deque<InputTerminalPtr>& input, const std::shared_ptr<Location>& location);
+		};
+
+		${{MachineName}}() = default;
+
+		std::shared_ptr<OutputProduction> apply(InputStream& rs) override { return apply(rs, m_runState); }
+		std::shared_ptr<OutputProduction> apply(InputStream& rs, RunState& state) const;
+
+		bool lastApplicationSuccessful() const override { return lastApplicationSuccessful(m_runState); }
+		static bool lastApplicationSuccessful(const RunState& state) { return m_stateFinality[state.m_currentState]; }
+		void reset() override { reset(m_runState); }
+		static void reset(RunState& state);
+
+		${{BatchProcessingDeclarations}}
 
 	private:
+		RunState m_runState;
+
 		// state-switching internals
-		State m_currentState;
 		static std::vector<State> m_stateMap[${{StateCount}}][${{TransitionSymbolCount}}];
 		static bool m_stateFinality[${{StateCount}}];
-		static std::vector<void (${{MachineName}}::*)(size_t, const std::deque<InputTerminalPtr>&, const std::shared_ptr<Location>&)> m_transitionActions[${{StateCount}}][${{TransitionSymbolCount}}];
-		static void (${{MachineName}}::* m_stateActions[${{StateCount}}])(size_t, const std::deque<InputTerminalPtr>&, const std::shared_ptr<Location>&);
-
-		// raw-capture internals
-		std::stack<size_t> m_captureStack;
+		static std::vector<ActionRegister> m_transitionActions[${{StateCount}}][${{TransitionSymbolCount}}];
+		static ActionRegister m_stateActions[${{StateCount}}];
 
 		// helper methods
 		${{CombineRawDeclaration}}
-
-		// dependency machines
-		${{DependencyMachineFields}}
-		// action contexts
-		std::shared_ptr<OutputProduction> m_token;
-		${{ActionContextsDeclarations}}
-		// actions
-		${{ActionDeclarations}}
+		${{KeywordRecognitionDeclaration}}
+		${{BatchProcessingHelperDeclaration}}
 	};
+
+	${{BatchProcessingDefinitions}}
 };
@@ -12,7 +12,7 @@
 
 // general dependencies
 #include "Terminal.h"
-#include "Parser.h"
+#include "Parser.h"${{ProfilerInclude}}
 
 // particular dependencies
 ${{DependencyHeaderIncludes}}
@@ -57,7 +57,7 @@ namespace ${{MachineName}} {
 
 	class ${{MachineName}} : public Parser<InputStream, OutputProduction> {
 	public:
-		${{MachineName}}() = default;
+		${{MachineName}}() = default;${{SynchronizationDeclaration}}${{ProfilerDeclaration}}
 
 	protected:
 		// helper methods
@@ -66,6 +66,6 @@ namespace ${{MachineName}} {
 		// dependency machines
 		${{DependencyMachineFields}}
 		// parsing declarations
-		${{ParsingDeclarations}}
+		${{ParsingDeclarations}}${{ProfilerField}}
 	};
 };
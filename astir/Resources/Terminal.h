@@ -16,4 +16,8 @@ protected:
 		: type(type), raw(), Production(occurenceLocation) { }
 	Terminal(TerminalTypeType type, const std::string& raw, const std::shared_ptr<Location>& occurenceLocation)
 		: type(type), raw(raw), Production(occurenceLocation) { }
-};
\ No newline at end of file
+};
+// the column of the transition tables a terminal type reads, bytes being taken as unsigned (the raw terminals are plain chars, signed on most platforms)
+inline size_t symbolIndexOf(char type) { return (unsigned char)type; }
+template <typename TerminalTypeType>
+size_t symbolIndexOf(TerminalTypeType type) { return (size_t)type; }
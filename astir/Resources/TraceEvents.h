@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// the Chrome trace-event JSON written by TraceEventLog, and by the generator itself for its `--trace` timeline
+struct TraceEventWriter {
+	static std::string quote(const std::string& text); // as a JSON string
+
+	// the events are written in between begin() and end(), the first one having to be told apart
+	static void begin(std::ostream& output) { output << "{\"traceEvents\": ["; }
+	static void writeThreadName(std::ostream& output, bool first, size_t thread, const std::string& threadName);
+	static void writeSpan(std::ostream& output, bool first, const std::string& name, const std::string& category, size_t thread, std::chrono::steady_clock::duration start, std::chrono::steady_clock::duration duration);
+	static void end(std::ostream& output) { output << "\n], \"displayTimeUnit\": \"ms\"}" << std::endl; }
+};
+
+inline std::string TraceEventWriter::quote(const std::string& text) {
+	std::stringstream ss;
+	ss << '"';
+	for (char character : text) {
+		if (character == '"' || character == '\\') {
+			ss << '\\' << character;
+		} else if ((unsigned char)character < 0x20) {
+			ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)character << std::dec;
+		} else {
+			ss << character;
+		}
+	}
+	ss << '"';
+	return ss.str();
+}
+
+inline void TraceEventWriter::writeThreadName(std::ostream& output, bool first, size_t thread, const std::string& threadName) {
+	output << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread << ", \"args\": { \"name\": " << quote(threadName) << " }}";
+}
+
+// the start is relative to the beginning of the trace
+inline void TraceEventWriter::writeSpan(std::ostream& output, bool first, const std::string& name, const std::string& category, size_t thread, std::chrono::steady_clock::duration start, std::chrono::steady_clock::duration duration) {
+	auto microseconds = [](std::chrono::steady_clock::duration duration) { return std::chrono::duration_cast<std::chrono::microseconds>(duration).count(); };
+	output << (first ? "\n" : ",\n") << "{\"name\": " << quote(name) << ", \"cat\": " << quote(category) << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread
+		<< ", \"ts\": " << microseconds(start) << ", \"dur\": " << microseconds(duration) << "}";
+}
+
+/*
+	A log of the time spans the machines spend tokenizing and parsing single documents, written out as Chrome trace-event JSON to be inspected in a trace viewer (chrome://tracing, Perfetto).
+	The spans are only taken by generated code compiled with ASTIR_INSTRUMENTATION defined, and only while a log is installed -- TraceEventLog::install(&log) -- by
+	processStream and its variants, parseStream and its variants, and processBatch for every document of the batch. Any number of threads may record into the installed log at once.
+*/
+class TraceEventLog {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	class Span {
+	public:
+		Span(const char* name, const char* category)
+			: m_log(TraceEventLog::installed()), m_name(name), m_category(category), m_start(m_log != nullptr ? Clock::now() : Clock::time_point()) { }
+		Span(const Span&) = delete;
+		Span& operator=(const Span&) = delete;
+		~Span() {
+			if (m_log != nullptr) {
+				m_log->record(m_name, m_category, m_start, Clock::now());
+			}
+		}
+
+	private:
+		TraceEventLog* m_log;
+		const char* m_name;
+		const char* m_category;
+		Clock::time_point m_start;
+	};
+
+	TraceEventLog()
+		: m_origin(Clock::now()) { }
+
+	static void install(TraceEventLog* log) { installedLog().store(log); } // nullptr to stop recording
+	static TraceEventLog* installed() { return installedLog().load(std::memory_order_relaxed); }
+
+	void record(const char* name, const char* category, Clock::time_point start, Clock::time_point end);
+	size_t size() const;
+	void write(std::ostream& output) const;
+	void clear();
+
+private:
+	struct Event {
+		const char* name;
+		const char* category;
+		Clock::time_point start;
+		Clock::duration duration;
+		size_t thread;
+	};
+
+	static std::atomic<TraceEventLog*>& installedLog() { static std::atomic<TraceEventLog*> log(nullptr); return log; }
+
+	mutable std::mutex m_mutex;
+	std::vector<Event> m_events;
+	std::map<std::thread::id, size_t> m_threads; // numbered in the order they have first recorded a span
+	Clock::time_point m_origin;
+};
+
+inline void TraceEventLog::record(const char* name, const char* category, Clock::time_point start, Clock::time_point end) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const size_t thread = m_threads.emplace(std::this_thread::get_id(), m_threads.size() + 1).first->second;
+	m_events.push_back({ name, category, start, end - start, thread });
+}
+
+inline size_t TraceEventLog::size() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_events.size();
+}
+
+inline void TraceEventLog::write(std::ostream& output) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	TraceEventWriter::begin(output);
+	bool first = true;
+	for (const auto& event : m_events) {
+		TraceEventWriter::writeSpan(output, first, event.name, event.category, event.thread, event.start - m_origin, event.duration);
+		first = false;
+	}
+	TraceEventWriter::end(output);
+}
+
+inline void TraceEventLog::clear() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_events.clear();
+	m_origin = Clock::now();
+}
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include "SyntacticTree.h"
 #include "MachineStatement.h"
+#include "CategoryClosure.h"
 
 #include <sstream>
 #include <stdexcept>
@@ -91,6 +92,10 @@ std::string ByteSymbolGroup::toString() const {
 	return std::string("'") + std::string(rangeStart, 1) + "' - " + std::string(rangeEnd, 1) + "'";
 }
 
+std::shared_ptr<SymbolGroup> ByteSymbolGroup::clone() const {
+	return std::make_shared<ByteSymbolGroup>(*this);
+}
+
 std::shared_ptr<std::list<SymbolIndex>> ByteSymbolGroup::retrieveSymbolIndices() const {
 	if (m_symbolIndicesFlyweight->empty()) {
 		for (ComputationCharType it = rangeStart; it <= (ComputationCharType)rangeEnd; ++it) {
@@ -125,6 +130,10 @@ std::string EmptySymbolGroup::toString() const {
 	return "empty";
 }
 
+std::shared_ptr<SymbolGroup> EmptySymbolGroup::clone() const {
+	return std::make_shared<EmptySymbolGroup>();
+}
+
 std::shared_ptr<std::list<SymbolIndex>> EmptySymbolGroup::retrieveSymbolIndices() const {
 	return std::shared_ptr<std::list<SymbolIndex>>();
 }
@@ -187,6 +196,15 @@ std::string SymbolGroupList::asSequenceString() const {
 	return ss.str();
 }
 
+SymbolGroupList SymbolGroupList::clone() const {
+	SymbolGroupList ret;
+	for (const auto& sgPtr : *this) {
+		ret.push_back(sgPtr->clone());
+	}
+
+	return ret;
+}
+
 SymbolGroupList& SymbolGroupList::operator+=(const SymbolGroupList& rhs) {
 	for (const auto& rhsItem : rhs) {
 		auto fit = std::find_if(cbegin(), cend(), [&rhsItem](const auto& sgPtr) {
@@ -243,6 +261,10 @@ std::string LiteralSymbolGroup::toString() const {
 	return "'" + this->literal + "'";
 }
 
+std::shared_ptr<SymbolGroup> LiteralSymbolGroup::clone() const {
+	return std::make_shared<LiteralSymbolGroup>(literal);
+}
+
 std::shared_ptr<std::list<SymbolIndex>> LiteralSymbolGroup::retrieveSymbolIndices() const {
 	throw std::logic_error("retrieveSymbolIndices() called on LiteralSymbolGroup -- an invalid call");
 	// make it into a(n internal) warning and just return an empty list, continuing with execution
@@ -274,7 +296,7 @@ bool StatementSymbolGroup::disjoint(const SymbolGroup* rhs) const {
 
 	const CategoryStatement* rhsStatementAsCategoryStatement = dynamic_cast<const CategoryStatement*>(rhsAsStatementSymbolGroup->statement);
 	if (rhsStatementAsCategoryStatement != nullptr) {
-		if (rhsStatementAsCategoryStatement->categoricallyRefersTo(this->statement)) {
+		if (categoricallyRefersTo(rhsStatementAsCategoryStatement, this->statement)) {
 			return false;
 		}
 	}
@@ -284,7 +306,7 @@ bool StatementSymbolGroup::disjoint(const SymbolGroup* rhs) const {
 		return true;
 	}
 
-	if (thisStatementAsCategoryStatement->categoricallyRefersTo(rhsAsStatementSymbolGroup->statement)) {
+	if (categoricallyRefersTo(thisStatementAsCategoryStatement, rhsAsStatementSymbolGroup->statement)) {
 		return false;
 	}
 
@@ -303,12 +325,12 @@ std::list<std::pair<std::shared_ptr<SymbolGroup>, bool>> StatementSymbolGroup::d
 
 	const CategoryStatement* rhsStatementAsCategoryStatement = dynamic_cast<const CategoryStatement*>(rhsAsStatementSymbolGroup->statement);
 	if (rhsStatementAsCategoryStatement != nullptr) {
-		std::set<const AttributedStatement*> disjoined = rhsStatementAsCategoryStatement->unpickReferal(statement);
+		std::set<const AttributedStatement*> disjoined = unpickReferal(rhsStatementAsCategoryStatement, statement);
 		std::list<std::pair<std::shared_ptr<SymbolGroup>, bool>> ret;
 		for (const AttributedStatement* as : disjoined) {
 			auto asAsTypeForming = dynamic_cast<const TypeFormingStatement*>(as);
 			if (asAsTypeForming != nullptr) {
-				ret.emplace_back(std::make_shared<StatementSymbolGroup>(asAsTypeForming, rhsAsStatementSymbolGroup->statementMachine), true); // comes from rhs, hence true
+				ret.emplace_back(std::make_shared<StatementSymbolGroup>(asAsTypeForming, rhsAsStatementSymbolGroup->statementMachine, rhsAsStatementSymbolGroup->categoryClosure), true); // comes from rhs, hence true
 			}
 		}
 
@@ -320,16 +342,17 @@ std::list<std::pair<std::shared_ptr<SymbolGroup>, bool>> StatementSymbolGroup::d
 		return std::list<std::pair<std::shared_ptr<SymbolGroup>, bool>>({ { rhs, true } });
 	}
 
-	if (thisStatementAsCategoryStatement->categoricallyRefersTo(rhsAsStatementSymbolGroup->statement)) {
-		std::set<const AttributedStatement*> disjoinment = thisStatementAsCategoryStatement->unpickReferal(rhsAsStatementSymbolGroup->statement);
+	if (categoricallyRefersTo(thisStatementAsCategoryStatement, rhsAsStatementSymbolGroup->statement)) {
+		std::set<const AttributedStatement*> disjoinment = unpickReferal(thisStatementAsCategoryStatement, rhsAsStatementSymbolGroup->statement);
 		this->statement = rhsAsStatementSymbolGroup->statement;
 		this->statementMachine = rhsAsStatementSymbolGroup->statementMachine;
+		this->categoryClosure = rhsAsStatementSymbolGroup->categoryClosure;
 
 		std::list<std::pair<std::shared_ptr<SymbolGroup>, bool>> ret;
 		for (const AttributedStatement* as : disjoinment) {
 			auto asAsTypeForming = dynamic_cast<const TypeFormingStatement*>(as);
 			if (asAsTypeForming != nullptr) {
-				ret.emplace_back(std::make_shared<StatementSymbolGroup>(asAsTypeForming, rhsAsStatementSymbolGroup->statementMachine), false); // comes from lhs, hence false
+				ret.emplace_back(std::make_shared<StatementSymbolGroup>(asAsTypeForming, rhsAsStatementSymbolGroup->statementMachine, rhsAsStatementSymbolGroup->categoryClosure), false); // comes from lhs, hence false
 			}
 		}
 		return ret;
@@ -342,9 +365,13 @@ std::string StatementSymbolGroup::toString() const {
 	return statement->name;
 }
 
+std::shared_ptr<SymbolGroup> StatementSymbolGroup::clone() const {
+	return std::make_shared<StatementSymbolGroup>(statement, statementMachine, categoryClosure);
+}
+
 std::shared_ptr<std::list<SymbolIndex>> StatementSymbolGroup::retrieveSymbolIndices() const {
 	if (m_symbolIndicesFlyweight->empty()) {
-		auto referencedProductions = statement->calculateInstandingProductions();
+		auto referencedProductions = categoryClosure != nullptr ? categoryClosure->calculateInstandingProductions(statement) : statement->calculateInstandingProductions();
 		for (const ProductionStatement* referencedComponentPtr : referencedProductions) {
 			if (referencedComponentPtr->terminality != Terminality::Terminal) {
 				throw std::logic_error("Calling retrieveSymbolIndices on at least partially non-terminal statement");
@@ -355,3 +382,19 @@ std::shared_ptr<std::list<SymbolIndex>> StatementSymbolGroup::retrieveSymbolIndi
 
 	return m_symbolIndicesFlyweight;
 }
+
+bool StatementSymbolGroup::categoricallyRefersTo(const AttributedStatement* referrer, const AttributedStatement* referee) const {
+	if (categoryClosure != nullptr) {
+		return categoryClosure->categoricallyRefersTo(referrer, referee);
+	}
+
+	return referrer->categoricallyRefersTo(referee);
+}
+
+std::set<const AttributedStatement*> StatementSymbolGroup::unpickReferal(const AttributedStatement* referrer, const AttributedStatement* referee) const {
+	if (categoryClosure != nullptr) {
+		return categoryClosure->unpickReferal(referrer, referee);
+	}
+
+	return referrer->unpickReferal(referee);
+}
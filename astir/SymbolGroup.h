@@ -2,6 +2,7 @@
 
 #include <string>
 #include <list>
+#include <set>
 #include <memory>
 
 #include "CharType.h"
@@ -16,6 +17,7 @@ public:
 	virtual bool disjoint(const SymbolGroup* rhs) const = 0;
 	virtual std::list<std::pair<std::shared_ptr<SymbolGroup>, bool>> disjoinFrom(const std::shared_ptr<SymbolGroup>& rhs) = 0;
 	virtual std::string toString() const = 0;
+	virtual std::shared_ptr<SymbolGroup> clone() const = 0;
 
 	virtual std::shared_ptr<std::list<SymbolIndex>> retrieveSymbolIndices() const = 0;
 protected:
@@ -36,6 +38,7 @@ public:
 	void removeEmpty();
 
 	std::string asSequenceString() const;
+	SymbolGroupList clone() const; // deep copy, as the disjoinFrom procedures modify the symbol groups in place
 
 	SymbolGroupList& operator+=(const SymbolGroupList& rhs);
 };
@@ -48,6 +51,7 @@ public:
 	bool disjoint(const SymbolGroup* rhs) const override;
 	std::list<std::pair<std::shared_ptr<SymbolGroup>, bool>> disjoinFrom(const std::shared_ptr<SymbolGroup>& rhs) override;
 	std::string toString() const override;
+	std::shared_ptr<SymbolGroup> clone() const override;
 
 	std::shared_ptr<std::list<SymbolIndex>> retrieveSymbolIndices() const override;
 protected:
@@ -65,6 +69,7 @@ struct ByteSymbolGroup : public SymbolGroup {
 	bool disjoint(const SymbolGroup* rhs) const override;
 	std::list<std::pair<std::shared_ptr<SymbolGroup>, bool>> disjoinFrom(const std::shared_ptr<SymbolGroup>& rhs) override;
 	std::string toString() const override;
+	std::shared_ptr<SymbolGroup> clone() const override;
 
 	CharType rangeStart;
 	CharType rangeEnd;
@@ -83,6 +88,7 @@ struct LiteralSymbolGroup : public SymbolGroup {
 	bool disjoint(const SymbolGroup* rhs) const override;
 	std::list<std::pair<std::shared_ptr<SymbolGroup>, bool>> disjoinFrom(const std::shared_ptr<SymbolGroup>& rhs) override;
 	std::string toString() const override;
+	std::shared_ptr<SymbolGroup> clone() const override;
 
 	std::string literal;
 
@@ -90,22 +96,29 @@ struct LiteralSymbolGroup : public SymbolGroup {
 };
 
 struct TypeFormingStatement;
+struct AttributedStatement;
 struct MachineDefinition;
+struct CategoryClosure;
 struct StatementSymbolGroup : public SymbolGroup {
 	StatementSymbolGroup() = default;
-	StatementSymbolGroup(const TypeFormingStatement* statement, const MachineDefinition* statementMachine)
-		: SymbolGroup(), statement(statement), statementMachine(statementMachine), m_symbolIndicesFlyweight(std::make_shared<std::list<SymbolIndex>>()) { }
+	StatementSymbolGroup(const TypeFormingStatement* statement, const MachineDefinition* statementMachine, const CategoryClosure* categoryClosure)
+		: SymbolGroup(), statement(statement), statementMachine(statementMachine), categoryClosure(categoryClosure), m_symbolIndicesFlyweight(std::make_shared<std::list<SymbolIndex>>()) { }
 
 	bool equals(const SymbolGroup* rhs) const override;
 	bool disjoint(const SymbolGroup* rhs) const override;
 	std::list<std::pair<std::shared_ptr<SymbolGroup>, bool>> disjoinFrom(const std::shared_ptr<SymbolGroup>& rhs) override;
 	std::string toString() const override;
+	std::shared_ptr<SymbolGroup> clone() const override;
 
 	const TypeFormingStatement* statement;
 	const MachineDefinition* statementMachine;
+	const CategoryClosure* categoryClosure; // of the machine in the context of which the symbol group is used
 
 	std::shared_ptr<std::list<SymbolIndex>> retrieveSymbolIndices() const override;
 
 private:
 	std::shared_ptr<std::list<SymbolIndex>> m_symbolIndicesFlyweight;
+
+	bool categoricallyRefersTo(const AttributedStatement* referrer, const AttributedStatement* referee) const;
+	std::set<const AttributedStatement*> unpickReferal(const AttributedStatement* referrer, const AttributedStatement* referee) const;
 };
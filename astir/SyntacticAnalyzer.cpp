@@ -26,6 +26,8 @@ std::unique_ptr<SyntacticTree> SyntacticAnalyzer::process(const std::list<Token>
 
 		unique_ptr<MachineDefinition> machineDefinition;
 		if ((machineDefinition = SyntacticAnalyzer::parseMachineDefinition(it))) {
+			machineDefinition->sourceFingerprint = fingerprintTokens(savedIt, it);
+
 			const std::string& incomingMachineDefinitionName = machineDefinition->name;
 			auto fit = specificationFile->machineDefinitions.find(incomingMachineDefinitionName);
 			if (fit != specificationFile->machineDefinitions.end()) {
@@ -42,6 +44,15 @@ std::unique_ptr<SyntacticTree> SyntacticAnalyzer::process(const std::list<Token>
 	return specificationFile;
 }
 
+Fingerprint SyntacticAnalyzer::fingerprintTokens(std::list<Token>::const_iterator begin, std::list<Token>::const_iterator end) const {
+	// only types and contents are considered, locations are not -- moving a definition around or reformatting it does not change it
+	FingerprintBuilder builder;
+	for (auto it = begin; it != end; ++it) {
+		builder << (Fingerprint)it->type << it->string;
+	}
+	return builder.value();
+}
+
 std::unique_ptr<UsesStatement> SyntacticAnalyzer::parseUsesStatement(std::list<Token>::const_iterator& it) const {
 	auto savedIt = it;
 	if (it->type != TokenType::KW_USES) {
@@ -123,6 +134,26 @@ std::unique_ptr<MachineDefinition> SyntacticAnalyzer::parseMachineDefinition(std
 		}
 	} 
 
+	if (it->type == TokenType::KW_SYNC) {
+		++it;
+		if (it->type != TokenType::IDENTIFIER) {
+			throw UnexpectedTokenException(*it, "an identifier for the terminal to synchronize at to follow the 'sync' keyword", "for machine declaration", *savedIt);
+		}
+		machineDefinition->synchronizingTerminals.emplace(it->string, nullptr);
+		++it;
+
+		while (it->type == TokenType::OP_COMMA) {
+			++it;
+
+			if (it->type != TokenType::IDENTIFIER) {
+				throw UnexpectedTokenException(*it, "an identifier for the terminal to synchronize at in the 'sync' clause", "for machine declaration", *savedIt);
+			}
+
+			machineDefinition->synchronizingTerminals.emplace(it->string, nullptr);
+			++it;
+		}
+	}
+
 	if (it->type == TokenType::OP_SEMICOLON) {
 		++it;
 		return machineDefinition;
@@ -175,6 +206,10 @@ bool SyntacticAnalyzer::tryParseMachineFlag(std::list<Token>::const_iterator& it
 		setting = make_pair<MachineFlag, bool>(MachineFlag::AmbiguityResolvedByPrecedence, false);
 	} else if (it->type == TokenType::KW_AMBIGUITY_RESOLVED_BY_PRECEDENCE) {
 		setting = make_pair<MachineFlag, bool>(MachineFlag::AmbiguityResolvedByPrecedence, true);
+	} else if (it->type == TokenType::KW_KEYWORDS_HASHED) {
+		setting = make_pair<MachineFlag, bool>(MachineFlag::KeywordsHashed, true);
+	} else if (it->type == TokenType::KW_KEYWORDS_IN_AUTOMATON) {
+		setting = make_pair<MachineFlag, bool>(MachineFlag::KeywordsHashed, false);
 	} else {
 		return false;
 	}
@@ -17,6 +17,7 @@ public:
 
 	std::unique_ptr<SyntacticTree> process(const std::list<Token>& tokens) const;
 private:
+	Fingerprint fingerprintTokens(std::list<Token>::const_iterator begin, std::list<Token>::const_iterator end) const;
 	std::unique_ptr<UsesStatement> parseUsesStatement(std::list<Token>::const_iterator& it) const;
 	
 	std::unique_ptr<MachineDefinition> parseMachineDefinition(std::list<Token>::const_iterator& it) const;
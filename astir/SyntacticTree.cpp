@@ -3,6 +3,9 @@
 #include "GenerationVisitor.h"
 #include "NFABuilder.h"
 #include "SemanticAnalysisException.h"
+#include "MachineScheduler.h"
+#include "GeneratorTrace.h"
+#include "FiniteAutomatonDefinition.h"
 
 #include <set>
 #include <algorithm>
@@ -22,10 +25,22 @@ void SyntacticTree::initialize() {
 		completeMachineHierarchy(namesEncountered, definitionPair.second);
 	}
 
-	// and, finally, internally initialize all machines
-	for (const auto& machinePair : machineDefinitions) {
-		machinePair.second->initialize();
+	// the machines using others add references to the categories of those, so that is done up front rather than while the others are being read concurrently
+	for (const auto& definitionPair : machineDefinitions) {
+		definitionPair.second->completeCategoryHierarchy();
 	}
+
+	// and, finally, internally initialize all machines -- each after the ones it depends on, independent ones concurrently
+	MachineScheduler scheduler(machineDefinitions, jobCount);
+	scheduler.run([this](const std::shared_ptr<MachineDefinition>& machine) {
+		GeneratorTrace::Span initializationSpan(trace, "initialize " + machine->name, "initialization");
+		machine->initialize();
+		// the building is done within the initialization, on the same thread
+		if (trace != nullptr && machine->constructionDuration() != std::chrono::steady_clock::duration::zero()) {
+			const bool isFiniteAutomaton = std::dynamic_pointer_cast<FiniteAutomatonDefinition>(machine) != nullptr;
+			trace->record((isFiniteAutomaton ? "subset construction " : "LL(k) disambiguation ") + machine->name, isFiniteAutomaton ? "pseudoDFABuilding" : "llkBuilding", machine->constructionStart(), machine->constructionDuration());
+		}
+	});
 }
 
 void SyntacticTree::completeMachineHierarchy(std::list<std::string>& namesEncountered, const std::shared_ptr<MachineDefinition>& machineDefinitionToComplete) const {
@@ -68,6 +83,93 @@ void SyntacticTree::completeMachineHierarchy(std::list<std::string>& namesEncoun
 	namesEncountered.pop_back();
 }
 
+Fingerprint SyntacticTree::machineFingerprint(const std::string& machineName) const {
+	std::set<std::string> namesEncountered;
+	FingerprintBuilder builder;
+	builder << machineFingerprint(machineName, namesEncountered);
+
+	// the machines using this one (or its dependencies) may declare statements of their own to be of their categories -- those are not generated with it (see MachineDefinition::completeCategoryReferences),
+	// but any change to them outdates it all the same, so that neither the manifest nor the cache ever has to tell which of them could matter
+	std::set<std::string> extendableNames;
+	collectDependencies(machineName, extendableNames);
+	extendableNames.insert(machineName);
+	for (const auto& definitionPair : machineDefinitions) {
+		if (extendableNames.count(definitionPair.first) > 0) {
+			continue;
+		}
+
+		std::set<std::string> dependencyNames;
+		collectDependencies(definitionPair.first, dependencyNames);
+		bool extends = false;
+		for (const auto& statementPair : definitionPair.second->statements) {
+			auto attributedStatement = std::dynamic_pointer_cast<AttributedStatement>(statementPair.second);
+			if (!attributedStatement) {
+				continue;
+			}
+			for (const auto& categoryPair : attributedStatement->categories) {
+				for (const std::string& dependencyName : dependencyNames) {
+					auto dependencyIt = machineDefinitions.find(dependencyName);
+					if (extendableNames.count(dependencyName) == 0 || dependencyIt == machineDefinitions.end()) {
+						continue;
+					}
+					auto categoryIt = dependencyIt->second->statements.find(categoryPair.first);
+					if (categoryIt != dependencyIt->second->statements.end() && std::dynamic_pointer_cast<CategoryStatement>(categoryIt->second)) {
+						builder << definitionPair.first << statementPair.first << dependencyName << categoryPair.first;
+						extends = true;
+					}
+				}
+			}
+		}
+		if (extends) {
+			builder << definitionPair.second->sourceFingerprint;
+		}
+	}
+	return builder.value();
+}
+
+void SyntacticTree::collectDependencies(const std::string& machineName, std::set<std::string>& dependencyNames) const {
+	auto machineIt = machineDefinitions.find(machineName);
+	if (machineIt == machineDefinitions.end()) {
+		return;
+	}
+
+	std::list<std::string> dependencyCandidates;
+	if (!machineIt->second->on.first.empty()) {
+		dependencyCandidates.push_back(machineIt->second->on.first);
+	}
+	for (const auto& usesPair : machineIt->second->uses) {
+		dependencyCandidates.push_back(usesPair.first);
+	}
+	for (const std::string& dependencyName : dependencyCandidates) {
+		if (dependencyNames.insert(dependencyName).second) {
+			collectDependencies(dependencyName, dependencyNames);
+		}
+	}
+}
+
+Fingerprint SyntacticTree::machineFingerprint(const std::string& machineName, std::set<std::string>& namesEncountered) const {
+	// this may well be called before the hierarchy is verified, hence the names are resolved here and any recursion is simply cut short
+	FingerprintBuilder builder;
+	builder << machineName;
+
+	auto machineIt = machineDefinitions.find(machineName);
+	if (machineIt == machineDefinitions.end() || !namesEncountered.insert(machineName).second) {
+		return builder.value();
+	}
+
+	const auto& machine = machineIt->second;
+	builder << machine->sourceFingerprint;
+	if (!machine->on.first.empty()) {
+		builder << machineFingerprint(machine->on.first, namesEncountered);
+	}
+	for (const auto& usesPair : machine->uses) {
+		builder << machineFingerprint(usesPair.first, namesEncountered);
+	}
+
+	namesEncountered.erase(machineName);
+	return builder.value();
+}
+
 void SyntacticTree::accept(GenerationVisitor* visitor) const {
 	visitor->visit(this);
 }
@@ -10,6 +10,9 @@
 #include "Field.h"
 #include "NFA.h"
 #include "ILLkFirstable.h"
+#include "Fingerprint.h"
+
+#include <set>
 
 /*
 	As a general rule, avoid creating full insertive constructors for objects, since the container ownership of unique_ptrs then often gets quite tricky.
@@ -18,16 +21,27 @@
 
 struct UsesStatement;
 struct MachineDefinition;
+class GeneratorTrace;
 struct SyntacticTree : public ISyntacticEntity, public ISemanticEntity, public IGenerationVisitable {
 	std::list<std::unique_ptr<UsesStatement>> usesStatements;
 	std::map<std::string, std::shared_ptr<MachineDefinition>> machineDefinitions;
+	unsigned int jobCount; // the number of machines processed concurrently, 0 for as many as there are hardware threads
+	GeneratorTrace* trace; // records what has been done to every machine when, if set
+
+	SyntacticTree()
+		: jobCount(0), trace(nullptr) { }
 
 	// semantic bit
 	void initialize() override;
 	void completeMachineHierarchy(std::list<std::string>& namesEncountered, const std::shared_ptr<MachineDefinition>& machineDefinitionToComplete) const;
+	Fingerprint machineFingerprint(const std::string& machineName) const; // of the machine definition together with all of its dependencies and the statements other machines declare to be of its categories
 
 	// generation bit
 	void accept(GenerationVisitor* visitor) const override;
+
+private:
+	Fingerprint machineFingerprint(const std::string& machineName, std::set<std::string>& namesEncountered) const;
+	void collectDependencies(const std::string& machineName, std::set<std::string>& dependencyNames) const;
 };
 
 struct UsesStatement : public ISyntacticEntity {
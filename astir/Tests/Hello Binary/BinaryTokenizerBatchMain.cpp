@@ -0,0 +1,70 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "Output/BinaryTokenizer.h"
+#include "BinaryTokenizerTesting.h"
+
+// tokenizes many short synthetic documents with processBatch of the generated BinaryTokenizer and one by one with a new stream for each,
+// checks that they agree and compares their throughput
+
+std::vector<std::string> synthesizeDocuments(size_t count) {
+	std::mt19937 generator(42);
+	std::uniform_int_distribution<int> runCount(1, 12);
+
+	std::vector<std::string> ret(count);
+	for (size_t documentIndex = 0; documentIndex < count; ++documentIndex) {
+		std::string& document = ret[documentIndex];
+		for (int runCounter = runCount(generator); runCounter > 0; --runCounter) {
+			appendDigitRun(generator, document);
+			appendWhiteSpaceRun(generator, document, 1);
+		}
+		// every now and then a document that does not tokenize
+		if (documentIndex % 97 == 0) {
+			document.push_back('2');
+		}
+	}
+	return ret;
+}
+
+int main() {
+	const std::vector<std::string> documents = synthesizeDocuments(200000);
+	size_t byteCount = 0;
+	std::vector<std::pair<const char*, const char*>> spans;
+	for (const auto& document : documents) {
+		spans.emplace_back(document.data(), document.data() + document.size());
+		byteCount += document.size();
+	}
+	const double megabytes = byteCount / (1024.0 * 1024.0);
+
+	BinaryTokenizer::BinaryTokenizer tokenizer;
+	std::vector<std::pair<size_t, BinaryTokenizer::OutputProductionPtr>> oneByOneTokens;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t documentIndex = 0; documentIndex < documents.size(); ++documentIndex) {
+		std::stringstream inputStream(documents[documentIndex]);
+		RawStream rs(inputStream, std::make_shared<TextLocation>());
+		tokenizer.reset();
+		for (const auto& token : tokenizer.processStream(rs)) {
+			oneByOneTokens.emplace_back(documentIndex, token);
+		}
+	}
+	double oneByOneSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<std::pair<size_t, BinaryTokenizer::OutputProductionPtr>> batchTokens;
+	start = std::chrono::steady_clock::now();
+	tokenizer.processBatch(spans, std::make_shared<TextLocation>(), [&batchTokens](size_t documentIndex, const BinaryTokenizer::OutputProductionPtr& token) {
+		batchTokens.emplace_back(documentIndex, token);
+	});
+	double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	bool agree = tokensAgree(oneByOneTokens, batchTokens);
+	std::cout << "Token sequences " << (agree ? "agree" : "DIFFER") << " (" << batchTokens.size() << " tokens in " << documents.size() << " documents)" << std::endl;
+
+	std::cout << "One by one: " << megabytes / oneByOneSeconds << " MB/s" << std::endl;
+	std::cout << "Batch:      " << megabytes / batchSeconds << " MB/s" << std::endl;
+
+	return agree ? 0 : 1;
+}
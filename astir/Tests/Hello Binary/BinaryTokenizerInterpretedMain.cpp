@@ -0,0 +1,47 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+#include "Output/BinaryTokenizer.h"
+#include "Output/InterpretedAutomaton.h"
+#include "BinaryTokenizerTesting.h"
+
+// runs the generated BinaryTokenizer side by side with the one interpreted from Output/BinaryTokenizer.astirt (astir --interpretable)
+// over the same synthetic input, checks that they agree and compares their throughput
+
+template <typename MachineType>
+double measure(MachineType& machine, const std::string& input, size_t& tokenCount) {
+	std::stringstream inputStream(input);
+	RawStream rs(inputStream, std::make_shared<TextLocation>());
+
+	auto start = std::chrono::steady_clock::now();
+	auto tokens = machine.processStream(rs);
+	auto end = std::chrono::steady_clock::now();
+
+	tokenCount = tokens.size();
+	return std::chrono::duration<double>(end - start).count();
+}
+
+int main() {
+	const std::string input = synthesizeInput(4 * 1024 * 1024);
+
+	BinaryTokenizer::BinaryTokenizer generatedTokenizer;
+	InterpretedAutomaton interpretedTokenizer(InterpretedAutomatonTable::loadFile("Output/BinaryTokenizer.astirt"));
+
+	// the token sequences must be identical
+	std::stringstream generatedInput(input), interpretedInput(input);
+	RawStream generatedRs(generatedInput, std::make_shared<TextLocation>()), interpretedRs(interpretedInput, std::make_shared<TextLocation>());
+	auto generatedTokens = generatedTokenizer.processStream(generatedRs);
+	auto interpretedTokens = interpretedTokenizer.processStream(interpretedRs);
+	bool agree = tokensAgree(generatedTokens, interpretedTokens);
+	std::cout << "Token sequences " << (agree ? "agree" : "DIFFER") << " (" << generatedTokens.size() << " tokens)" << std::endl;
+
+	size_t tokenCount;
+	const double megabytes = input.size() / (1024.0 * 1024.0);
+	double generatedSeconds = measure(generatedTokenizer, input, tokenCount);
+	std::cout << "Generated:   " << megabytes / generatedSeconds << " MB/s, " << tokenCount / generatedSeconds << " tokens/s" << std::endl;
+	double interpretedSeconds = measure(interpretedTokenizer, input, tokenCount);
+	std::cout << "Interpreted: " << megabytes / interpretedSeconds << " MB/s, " << tokenCount / interpretedSeconds << " tokens/s" << std::endl;
+
+	return agree ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "Output/BinaryTokenizer.h"
+#include "Output/ParallelTokenizer.h"
+#include "BinaryTokenizerTesting.h"
+
+// runs the generated BinaryTokenizer sequentially and on all the threads there are with ParallelTokenizer
+// over the same synthetic input, checks that they agree and compares their throughput
+
+int main() {
+	const std::string input = synthesizeInput(16 * 1024 * 1024);
+	const double megabytes = input.size() / (1024.0 * 1024.0);
+
+	BinaryTokenizer::BinaryTokenizer sequentialTokenizer;
+	std::stringstream inputStream(input);
+	RawStream rs(inputStream, std::make_shared<TextLocation>());
+	auto start = std::chrono::steady_clock::now();
+	auto sequentialTokens = sequentialTokenizer.processStream(rs);
+	double sequentialSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	ParallelTokenizer<BinaryTokenizer::BinaryTokenizer> parallelTokenizer;
+	start = std::chrono::steady_clock::now();
+	auto parallelTokens = parallelTokenizer.processStream(input.data(), input.data() + input.size(), std::make_shared<TextLocation>());
+	double parallelSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// the token sequences must be identical, locations included
+	bool agree = tokensAgree(sequentialTokens, parallelTokens);
+	std::cout << "Token sequences " << (agree ? "agree" : "DIFFER") << " (" << sequentialTokens.size() << " tokens)" << std::endl;
+
+	std::cout << "Sequential:             " << megabytes / sequentialSeconds << " MB/s" << std::endl;
+	std::cout << "Parallel (" << parallelTokenizer.threadCount() << " threads): " << megabytes / parallelSeconds << " MB/s" << std::endl;
+
+	return agree ? 0 : 1;
+}
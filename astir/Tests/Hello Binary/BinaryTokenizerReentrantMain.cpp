@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "Output/BinaryTokenizer.h"
+#include "BinaryTokenizerTesting.h"
+
+// runs a single generated BinaryTokenizer on more and more threads at once, every thread tokenizing documents of its own with a run state of its own,
+// checks that every thread gets the very same tokens as the machine run on its own does and reports how the throughput scales
+
+std::list<BinaryTokenizer::OutputProductionPtr> tokenize(const BinaryTokenizer::BinaryTokenizer& tokenizer, BinaryTokenizer::BinaryTokenizer::RunState& state, const std::string& document) {
+	std::stringstream inputStream(document);
+	RawStream rs(inputStream, std::make_shared<TextLocation>());
+
+	// just like processStream does it
+	std::list<BinaryTokenizer::OutputProductionPtr> ret;
+	bool wasLastApplicationSuccessful;
+	do {
+		ret.push_back(tokenizer.apply(rs, state));
+		wasLastApplicationSuccessful = BinaryTokenizer::BinaryTokenizer::lastApplicationSuccessful(state);
+		if (wasLastApplicationSuccessful) {
+			BinaryTokenizer::BinaryTokenizer::reset(state);
+		}
+	} while (wasLastApplicationSuccessful && rs.good());
+
+	return ret;
+}
+
+int main() {
+	const size_t documentLength = 1024 * 1024;
+	const unsigned int maxThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	std::vector<std::string> documents;
+	std::vector<std::list<BinaryTokenizer::OutputProductionPtr>> expectedTokens;
+	for (unsigned int documentIndex = 0; documentIndex < maxThreadCount; ++documentIndex) {
+		documents.push_back(synthesizeInput(documentLength, 42 + documentIndex));
+
+		BinaryTokenizer::BinaryTokenizer ownTokenizer;
+		std::stringstream inputStream(documents.back());
+		RawStream rs(inputStream, std::make_shared<TextLocation>());
+		expectedTokens.push_back(ownTokenizer.processStream(rs));
+	}
+
+	// the one machine all the threads share
+	const BinaryTokenizer::BinaryTokenizer sharedTokenizer;
+	bool agree = true;
+	double singleThreadThroughput = 0;
+	for (unsigned int threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2) {
+		std::vector<std::list<BinaryTokenizer::OutputProductionPtr>> tokens(threadCount);
+		std::vector<std::thread> threads;
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned int threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+			threads.emplace_back([&, threadIndex]() {
+				BinaryTokenizer::BinaryTokenizer::RunState state;
+				tokens[threadIndex] = tokenize(sharedTokenizer, state, documents[threadIndex]);
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		for (unsigned int threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+			agree = agree && tokensAgree(tokens[threadIndex], expectedTokens[threadIndex]);
+		}
+
+		double throughput = threadCount * documentLength / (1024.0 * 1024.0) / seconds;
+		if (threadCount == 1) {
+			singleThreadThroughput = throughput;
+		}
+		std::cout << threadCount << " threads: " << throughput << " MB/s (" << throughput / singleThreadThroughput << "x)" << std::endl;
+	}
+
+	std::cout << "Token sequences " << (agree ? "agree" : "DIFFER") << std::endl;
+	return agree ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+
+// what the BinaryTokenizer mains have in common: synthetic binary input to tokenize, and the comparison of the token sequences different ways of tokenizing it give
+
+// appends a run of 1 to 16 binary digits
+inline void appendDigitRun(std::mt19937& generator, std::string& input) {
+	std::uniform_int_distribution<int> runLength(1, 16);
+	std::uniform_int_distribution<int> digit(0, 1);
+	for (int counter = runLength(generator); counter > 0; --counter) {
+		input.push_back(digit(generator) ? '1' : '0');
+	}
+}
+
+// appends a run of white space of the given length
+inline void appendWhiteSpaceRun(std::mt19937& generator, std::string& input, int length) {
+	std::uniform_int_distribution<int> whiteSpace(0, 2);
+	for (int counter = length; counter > 0; --counter) {
+		input.push_back(" \t\n"[whiteSpace(generator)]);
+	}
+}
+
+// runs of binary digits separated by runs of 1 to 4 white space characters, the same seed giving the same input
+inline std::string synthesizeInput(size_t length, unsigned int seed = 42) {
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<int> runLength(1, 16);
+
+	std::string ret;
+	while (ret.size() < length) {
+		appendDigitRun(generator, ret);
+		appendWhiteSpaceRun(generator, ret, runLength(generator) / 4 + 1);
+	}
+	return ret;
+}
+
+// the type, text and location of a token (generated or interpreted), or null
+template <typename Production>
+std::string describe(const std::shared_ptr<Production>& token) {
+	std::stringstream ss;
+	if (token) {
+		ss << (size_t)token->type << ' ' << token->raw << ' ' << token->locationString();
+	} else {
+		ss << "null";
+	}
+	return ss.str();
+}
+
+// of a token in a batch, preceded by the index of its document
+template <typename Production>
+std::string describe(const std::pair<size_t, std::shared_ptr<Production>>& documentToken) {
+	return std::to_string(documentToken.first) + ' ' + describe(documentToken.second);
+}
+
+// whether the two sequences have the same tokens (or nulls) in the same order, locations included
+template <typename LhsSequence, typename RhsSequence>
+bool tokensAgree(const LhsSequence& lhs, const RhsSequence& rhs) {
+	if (lhs.size() != rhs.size()) {
+		return false;
+	}
+
+	auto rhsIt = rhs.cbegin();
+	for (auto lhsIt = lhs.cbegin(); lhsIt != lhs.cend(); ++lhsIt, ++rhsIt) {
+		if (describe(*lhsIt) != describe(*rhsIt)) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,110 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "Output/ParallelTreeTokenizer.h"
+#include "Output/ParallelTreeParser.h"
+#include "Output/ParallelParser.h"
+
+// parses a large synthetic forest with parseStream of the generated ParallelTreeParser of ParallelTree.astir and with ParallelParser on several thread counts (synchronizing after PAR_RIGHT),
+// checks that they agree, and that they fail the very same way on a forest with a stray PAR_RIGHT in the middle
+
+// appends a tree of up to the given depth, nested nodes making PAR_RIGHT terminals a root does not start after
+void appendTree(std::mt19937& generator, std::string& input, int depth) {
+	std::uniform_int_distribution<int> shape(0, 3);
+	std::uniform_int_distribution<int> childCount(1, 4);
+	std::uniform_int_distribution<int> letter(0, 25);
+
+	switch (depth > 0 ? shape(generator) : 0) {
+	case 0:
+		input.push_back((char)('a' + letter(generator)));
+		break;
+	case 1:
+		input += "()";
+		break;
+	default:
+		input.push_back('(');
+		for (int counter = childCount(generator); counter > 0; --counter) {
+			appendTree(generator, input, depth - 1);
+			input.push_back(' ');
+		}
+		input.push_back(')');
+		break;
+	}
+	input.push_back('\n');
+}
+
+std::string synthesizeForest(size_t length) {
+	std::mt19937 generator(42);
+	std::string ret;
+	while (ret.size() < length) {
+		appendTree(generator, ret, 4);
+	}
+	return ret;
+}
+
+// with a PAR_RIGHT no node has been opened for, halfway through
+std::string insertStrayParRight(std::string input) {
+	input.insert(input.find('\n', input.size() / 2) + 1, ")\n");
+	return input;
+}
+
+std::list<ParallelTreeTokenizer::OutputTerminalPtr> tokenize(const std::string& input) {
+	std::stringstream inputStream(input);
+	RawStream rs(inputStream, std::make_shared<TextLocation>());
+	ParallelTreeTokenizer::ParallelTreeTokenizer tokenizer;
+	return tokenizer.processStreamWithIgnorance(rs);
+}
+
+// the kinds and locations of the roots, or the error that stopped the parse
+template <typename ParseFunction>
+std::string describeParse(ParseFunction parse) {
+	std::stringstream ss;
+	try {
+		for (const auto& root : parse()) {
+			if (root) {
+				ss << root->stringForError() << ' ' << root->locationString() << std::endl;
+			} else {
+				ss << "null" << std::endl;
+			}
+		}
+	} catch (const Exception& ex) {
+		ss << "error: " << ex.what() << std::endl;
+	}
+	return ss.str();
+}
+
+int main() {
+	const std::string input = synthesizeForest(8 * 1024 * 1024);
+	const std::string erroneousInput = insertStrayParRight(input);
+
+	bool agree = true;
+	for (const std::string* currentInput : { &input, &erroneousInput }) {
+		const auto tokens = tokenize(*currentInput);
+
+		auto start = std::chrono::steady_clock::now();
+		const std::string expected = describeParse([&tokens]() {
+			ListProductionStream<ParallelTreeTokenizer::OutputTerminal> lps(tokens);
+			ParallelTreeParser::ParallelTreeParser parser;
+			return parser.parseStream(lps);
+		});
+		double sequentialSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << (currentInput == &input ? "Valid" : "Erroneous") << " input, " << tokens.size() << " tokens" << std::endl;
+		std::cout << "Sequential:           " << tokens.size() / sequentialSeconds << " tokens/s" << std::endl;
+
+		for (unsigned int threadCount : { 1u, 2u, 3u, 4u, 8u }) {
+			ParallelParser<ParallelTreeParser::ParallelTreeParser> parallelParser(threadCount);
+			start = std::chrono::steady_clock::now();
+			const std::string actual = describeParse([&parallelParser, &tokens]() { return parallelParser.parseStream(tokens); });
+			double parallelSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			const bool threadCountAgrees = actual == expected;
+			agree = agree && threadCountAgrees;
+			std::cout << "Parallel (" << threadCount << " threads): " << tokens.size() / parallelSeconds << " tokens/s" << (threadCountAgrees ? "" : ", DIFFERS") << std::endl;
+		}
+	}
+
+	std::cout << "Parses " << (agree ? "agree" : "DIFFER") << std::endl;
+	return agree ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "Output/TreeTokenizer.h"
+
+// tokenizes synthetic forests with the generated TreeTokenizer twice, once skipping the white space runs in one go and once with the buffer fixed,
+// which keeps the stream from being bypassed and has the runs read byte by byte, and checks that the tokens and their locations agree
+
+// appends a run of 1 to 4 white space characters
+void appendWhiteSpaceRun(std::mt19937& generator, std::string& input) {
+	std::uniform_int_distribution<int> runLength(1, 4);
+	std::uniform_int_distribution<int> whiteSpace(0, 2);
+	for (int counter = runLength(generator); counter > 0; --counter) {
+		input.push_back(" \t\n"[whiteSpace(generator)]);
+	}
+}
+
+// appends a tree of up to the given depth with white space around its nodes, so that the single byte PAR_LEFT, PAR_RIGHT and one letter identifiers often follow a skipped run
+void appendTree(std::mt19937& generator, std::string& input, int depth) {
+	std::uniform_int_distribution<int> shape(0, 3);
+	std::uniform_int_distribution<int> childCount(1, 4);
+	std::uniform_int_distribution<int> identifierLength(1, 3);
+	std::uniform_int_distribution<int> letter(0, 25);
+
+	appendWhiteSpaceRun(generator, input);
+	if (depth > 0 && shape(generator) > 0) {
+		input.push_back('(');
+		for (int counter = childCount(generator); counter > 0; --counter) {
+			appendTree(generator, input, depth - 1);
+		}
+		appendWhiteSpaceRun(generator, input);
+		input.push_back(')');
+	} else {
+		for (int counter = identifierLength(generator); counter > 0; --counter) {
+			input.push_back((char)('a' + letter(generator)));
+		}
+	}
+}
+
+std::string synthesizeForest(unsigned int seed) {
+	std::mt19937 generator(seed);
+	std::string ret;
+	for (int counter = 0; counter < 16; ++counter) {
+		appendTree(generator, ret, 4);
+	}
+	return ret;
+}
+
+std::string describeTokens(const std::string& input, bool skipping) {
+	std::stringstream inputStream(input);
+	RawStream rs(inputStream, std::make_shared<TextLocation>());
+	rs.setBufferFixed(!skipping);
+
+	TreeTokenizer::TreeTokenizer tokenizer;
+	std::stringstream ss;
+	for (const auto& token : tokenizer.processStreamWithIgnorance(rs)) {
+		if (token) {
+			ss << token->raw << ' ' << token->locationString() << std::endl;
+		} else {
+			ss << "null" << std::endl;
+		}
+	}
+	return ss.str();
+}
+
+int main() {
+	bool agree = true;
+	for (unsigned int seed = 0; seed < 256; ++seed) {
+		const std::string input = synthesizeForest(seed);
+		if (describeTokens(input, true) != describeTokens(input, false)) {
+			std::cout << "Locations DIFFER on seed " << seed << std::endl;
+			agree = false;
+		}
+	}
+
+	std::cout << "Locations " << (agree ? "agree" : "DIFFER") << std::endl;
+	return agree ? 0 : 1;
+}
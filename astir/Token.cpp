@@ -34,6 +34,8 @@ std::string Token::convertTypeToString(TokenType type) {
 	switch (type) {
 		case TokenType::KW_USES:
 			return "KW_USES";
+		case TokenType::KW_SYNC:
+			return "KW_SYNC";
 
 		case TokenType::KW_WITH:
 			return "KW_WITH";
@@ -65,6 +67,10 @@ std::string Token::convertTypeToString(TokenType type) {
 			return "KW_AMBIGUITY_DISALLOWED";
 		case TokenType::KW_AMBIGUITY_RESOLVED_BY_PRECEDENCE:
 			return "KW_AMBIGUITY_RESOLVED_BY_PRECEDENCE";
+		case TokenType::KW_KEYWORDS_HASHED:
+			return "KW_KEYWORDS_HASHED";
+		case TokenType::KW_KEYWORDS_IN_AUTOMATON:
+			return "KW_KEYWORDS_IN_AUTOMATON";
 		
 		case TokenType::KW_ROOT:
 			return "KW_ROOT";
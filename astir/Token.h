@@ -7,6 +7,7 @@
 
 enum class TokenType {
 	KW_USES,
+	KW_SYNC,
 
 	KW_ON,
 	KW_WITH,
@@ -24,6 +25,8 @@ enum class TokenType {
 	KW_CATEGORIES_NONROOT_BY_DEFAULT,
 	KW_AMBIGUITY_DISALLOWED,
 	KW_AMBIGUITY_RESOLVED_BY_PRECEDENCE,
+	KW_KEYWORDS_HASHED,
+	KW_KEYWORDS_IN_AUTOMATON,
 	
 	KW_IGNORED,
 	KW_ROOT,
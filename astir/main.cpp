@@ -2,14 +2,28 @@
 #include <fstream>
 #include <list>
 #include <string>
+#include <filesystem>
+#include <sstream>
+#include <iomanip>
 
 #include "LexicalAnalyzer.h"
 #include "SyntacticAnalyzer.h"
 #include "CppGenerationVisitor.h"
+#include "ConstructionCache.h"
+#include "CorpusGenerator.h"
+#include "GenerationException.h"
+#include "GenerationHelper.h"
+#include "GeneratorStatistics.h"
+#include "GeneratorTrace.h"
 
 #include "DimCli/libs/dimcli/cli.h"
 
 void printTokenList(const std::list<Token>& tokenList);
+void reportKeywordHashing(const SyntacticTree* tree, bool comparingToUnhashed);
+void reportBacktracking(const SyntacticTree* tree, bool rejectUnboundedRollback);
+void generateCorpus(const SyntacticTree* tree, const std::string& machineName, const std::filesystem::path& outputDirectoryPath, size_t byteCount, uint64_t seed, const std::string& weights);
+void writeStatistics(const GeneratorStatistics& statistics, const SyntacticTree* tree, const std::string& statisticsFilePath);
+void writeTrace(const GeneratorTrace& trace, const std::string& traceFilePath);
 
 #include "TestingSwitch.h"
 int main(int argc, char* argv[]) {
@@ -18,29 +32,90 @@ int main(int argc, char* argv[]) {
 	cli.versionOpt("1.0.0");
 	auto& grammarFilePath = cli.opt<std::string>("<grammarFilePath>").desc("The path to the containing the grammar specification that is to be processed");
 	auto& outputDirectoryPath = cli.opt<std::string>("outputDirectory", ".").desc("The directory where the generated files are meant to go.");
+	auto& jobCount = cli.opt<unsigned int>("jobs j", 0).desc("The number of machines to process concurrently, 0 for as many as there are hardware threads.");
+	auto& interpretable = cli.opt<bool>("interpretable", false).desc("Also write the finite automata on raw input out as tables to be run by the InterpretedAutomaton, without compiling any generated code.");
+	auto& rejectUnboundedRollback = cli.opt<bool>("rejectUnboundedRollback", false).desc("Fail instead of warning when a finite automaton may have to read back an unbounded number of symbols after the last token it has accepted.");
+	auto& profileParsers = cli.opt<bool>("profileParsers", false).desc("Have the generated parsers keep a ParserProfiler of the calls, time and lookahead of their productions.");
+	auto& cacheFilePath = cli.opt<std::string>("cacheFile", "").desc("The file the built automata and decision trees are cached in, '.astirc' in the output directory if not specified.");
+	auto& corpusMachineName = cli.opt<std::string>("corpus", "").desc("Instead of generating any code, write a random input valid for the machine of this name out to '<machine>.corpus' in the output directory.");
+	auto& corpusSize = cli.opt<size_t>("corpusSize", 1048576).desc("The size of the generated corpus in bytes (give or take the last token or sentence).");
+	auto& corpusSeed = cli.opt<uint64_t>("corpusSeed", 0).desc("The seed of the corpus generation, the same seed (and weights) giving the same corpus.");
+	auto& corpusWeights = cli.opt<std::string>("corpusWeights", "").desc("The relative probabilities of productions in the corpus, as in 'WORD=4,NUMBER=0.5', 1 for those not listed.");
+	auto& statisticsFilePath = cli.opt<std::string>("stats", "").desc("The file to write the wall time of every phase, the peak memory, and the sizes of the built machines to, as JSON.");
+	auto& traceFilePath = cli.opt<std::string>("trace", "").desc("The file to write the timeline of the phases and of the initialization, building and emission of every machine to, as Chrome trace-event JSON.");
 	if (!cli.parse(std::cerr, argc, argv))
 		return cli.exitCode();
 
 	std::fstream grammarFile(*grammarFilePath);
+	GeneratorStatistics statistics;
+	GeneratorTrace trace;
+	if (!traceFilePath->empty()) {
+		statistics.traceTo(&trace);
+	}
 
 	try {
 		LexicalAnalyzer lexicalAnalyzer;
 		std::cout << "Tokenizing grammar file" << std::endl;
+		statistics.beginPhase("lexing");
 		auto tokenList = lexicalAnalyzer.process(grammarFile);
 
 		SyntacticAnalyzer syntacticAnalyzer;
 		std::cout << "Parsing grammar file" << std::endl;
+		statistics.beginPhase("parsing");
 		std::shared_ptr<SyntacticTree> syntacticTree = syntacticAnalyzer.process(tokenList);
+		if (!traceFilePath->empty()) {
+			syntacticTree->trace = &trace;
+		}
+
+		if (!corpusMachineName->empty()) {
+			// the corpus is generated from the definitions alone, so nothing needs to be built
+			for (const auto& machineDefinitionPair : syntacticTree->machineDefinitions) {
+				machineDefinitionPair.second->markUpToDate();
+			}
+			std::cout << "Semantically processing the grammar" << std::endl;
+			statistics.beginPhase("initialization");
+			syntacticTree->jobCount = *jobCount;
+			syntacticTree->initialize();
+
+			statistics.beginPhase("corpusGeneration");
+			generateCorpus(syntacticTree.get(), *corpusMachineName, *outputDirectoryPath, *corpusSize, *corpusSeed, *corpusWeights);
+			statistics.endPhase();
+			writeStatistics(statistics, syntacticTree.get(), *statisticsFilePath);
+			writeTrace(trace, *traceFilePath);
+			return 0;
+		}
 		
+		// machines unchanged since the last run into the output directory need not be built nor generated again
+		statistics.beginPhase("cacheLoading");
+		CppGenerationVisitor generationVisitor(*outputDirectoryPath, *interpretable, *profileParsers);
+		generationVisitor.markUpToDateMachines(syntacticTree.get());
+		// the others may still be spared the building if a previous run has cached what they are built into
+		ConstructionCache constructionCache(cacheFilePath->empty() ? std::filesystem::path(*outputDirectoryPath) / ".astirc" : std::filesystem::path(*cacheFilePath));
+		constructionCache.load(syntacticTree.get());
+
 		std::cout << "Semantically processing the grammar" << std::endl;
+		statistics.beginPhase("initialization");
+		syntacticTree->jobCount = *jobCount;
 		syntacticTree->initialize();
+		reportBacktracking(syntacticTree.get(), *rejectUnboundedRollback);
 
-		CppGenerationVisitor generationVisitor(*outputDirectoryPath);
+		statistics.beginPhase("emission");
 		generationVisitor.setup();
 		std::cout << "Generating output code" << std::endl;
 		generationVisitor.visit(syntacticTree.get());
+		statistics.beginPhase("cacheStoring");
+		constructionCache.store(syntacticTree.get());
+		// telling what the keyword hashing spares takes building the automata with the keywords in them, which is only worth it when a report is asked for anyway
+		if (!statisticsFilePath->empty()) {
+			statistics.beginPhase("keywordHashingComparison");
+		}
+		reportKeywordHashing(syntacticTree.get(), !statisticsFilePath->empty());
+		statistics.endPhase();
+		writeStatistics(statistics, syntacticTree.get(), *statisticsFilePath);
+		writeTrace(trace, *traceFilePath);
 	} catch (const Exception& exception) {
 		std::cerr << "Error: " << exception.what() << std::endl;
+		return 1;
 	} 
 
 #else
@@ -91,3 +166,115 @@ void printTokenList(const std::list<Token>& tokenList) {
 			;
 	}
 }
+
+void reportKeywordHashing(const SyntacticTree* tree, bool comparingToUnhashed) {
+	for (const auto& machineDefinitionPair : tree->machineDefinitions) {
+		auto finiteAutomatonDefinition = std::dynamic_pointer_cast<FiniteAutomatonDefinition>(machineDefinitionPair.second);
+		if (!finiteAutomatonDefinition || finiteAutomatonDefinition->isUpToDate() || finiteAutomatonDefinition->getHashedKeywords().empty()) {
+			continue;
+		}
+
+		const size_t stateCount = finiteAutomatonDefinition->getNFA().states.size();
+		std::cout << "Hashed " << finiteAutomatonDefinition->getHashedKeywords().size() << " keywords of '" << machineDefinitionPair.first << "': ";
+		if (!comparingToUnhashed) {
+			std::cout << stateCount << " states" << std::endl;
+			continue;
+		}
+
+		// the generated transition tables have a cell for every state and byte
+		const size_t unhashedStateCount = finiteAutomatonDefinition->measureUnhashedStateCount();
+		std::cout << stateCount << " instead of " << unhashedStateCount << " states, "
+			<< stateCount * 256 << " instead of " << unhashedStateCount * 256 << " transition table cells" << std::endl;
+	}
+}
+
+void reportBacktracking(const SyntacticTree* tree, bool rejectUnboundedRollback) {
+	for (const auto& machineDefinitionPair : tree->machineDefinitions) {
+		auto finiteAutomatonDefinition = std::dynamic_pointer_cast<FiniteAutomatonDefinition>(machineDefinitionPair.second);
+		// the machines up to date have the analysis of their last build, recorded in the manifest
+		if (!finiteAutomatonDefinition || finiteAutomatonDefinition->backtracking().rollbackBounded) {
+			continue;
+		}
+
+		// bytes are shown as a string literal, terminals of the machine the automaton is on by their names
+		auto renderSymbols = [&finiteAutomatonDefinition](const std::vector<SymbolIndex>& symbols) {
+			std::stringstream ss;
+			if (finiteAutomatonDefinition->on.second) {
+				for (SymbolIndex symbolIndex : symbols) {
+					std::string terminalName = std::to_string(symbolIndex);
+					for (const auto& production : finiteAutomatonDefinition->on.second->getTerminalProductions()) {
+						if (production->terminalTypeIndex == symbolIndex) {
+							terminalName = production->name;
+						}
+					}
+					ss << (ss.tellp() > 0 ? " " : "") << terminalName;
+				}
+				return "(" + ss.str() + ")";
+			}
+
+			ss << '"';
+			for (SymbolIndex symbolIndex : symbols) {
+				if (symbolIndex == '"' || symbolIndex == '\\') {
+					ss << '\\' << (char)symbolIndex;
+				} else if (symbolIndex >= 0x20 && symbolIndex < 0x7f) {
+					ss << (char)symbolIndex;
+				} else {
+					ss << "\\x" << std::hex << std::setw(2) << std::setfill('0') << symbolIndex << std::dec << std::setfill(' ');
+				}
+			}
+			ss << '"';
+			return ss.str();
+		};
+
+		const BacktrackingAnalysis& backtracking = finiteAutomatonDefinition->backtracking();
+		const std::string message = "The finite automaton '" + machineDefinitionPair.first + "' declared at " + finiteAutomatonDefinition->locationString()
+			+ " may read back an unbounded number of symbols after the last token it has accepted: having read the token " + renderSymbols(backtracking.witnessToken)
+			+ ", reading on " + renderSymbols(backtracking.witnessLeadIn) + " followed by any number of " + renderSymbols(backtracking.witnessCycle)
+			+ " accepts nothing further, all of it being read again when no longer token turns up";
+		if (rejectUnboundedRollback) {
+			throw GenerationException(message);
+		}
+		std::cout << "Warning: " << message << std::endl;
+	}
+}
+
+void generateCorpus(const SyntacticTree* tree, const std::string& machineName, const std::filesystem::path& outputDirectoryPath, size_t byteCount, uint64_t seed, const std::string& weights) {
+	auto machineDefinitionIt = tree->machineDefinitions.find(machineName);
+	if (machineDefinitionIt == tree->machineDefinitions.cend()) {
+		throw GenerationException("No machine named '" + machineName + "' to generate a corpus for");
+	}
+
+	std::cout << "Generating a corpus for '" << machineName << "'" << std::endl;
+	CorpusGenerator corpusGenerator(*machineDefinitionIt->second, seed, CorpusGenerator::parseWeights(weights));
+	const std::string corpus = corpusGenerator.generate(byteCount);
+
+	std::filesystem::create_directories(outputDirectoryPath);
+	GenerationHelper::writeFileIfChanged(outputDirectoryPath / (machineName + ".corpus"), corpus, true);
+	std::cout << "Written " << corpus.size() << " bytes to '" << (outputDirectoryPath / (machineName + ".corpus")).string() << "'" << std::endl;
+}
+
+void writeStatistics(const GeneratorStatistics& statistics, const SyntacticTree* tree, const std::string& statisticsFilePath) {
+	if (statisticsFilePath.empty()) {
+		return;
+	}
+
+	std::ofstream statisticsFile(statisticsFilePath);
+	if (!statisticsFile) {
+		throw GenerationException("Could not open the statistics file '" + statisticsFilePath + "' for writing");
+	}
+	statistics.write(statisticsFile, tree);
+	std::cout << "Statistics written to '" << statisticsFilePath << "'" << std::endl;
+}
+
+void writeTrace(const GeneratorTrace& trace, const std::string& traceFilePath) {
+	if (traceFilePath.empty()) {
+		return;
+	}
+
+	std::ofstream traceFile(traceFilePath);
+	if (!traceFile) {
+		throw GenerationException("Could not open the trace file '" + traceFilePath + "' for writing");
+	}
+	trace.write(traceFile);
+	std::cout << "Trace written to '" << traceFilePath << "'" << std::endl;
+}